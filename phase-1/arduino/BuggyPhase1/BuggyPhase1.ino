@@ -3,35 +3,73 @@
 #include "motion.h"
 #include "servo_scan.h"
 #include "ultrasonic.h"
+#include "scan.h"
+#include "gaps.h"
 #include "serial_proto.h"
 #include "watchdog.h"
 #include "status.h"
+#include "battery.h"
+#include "host_link.h"
+#include "follow.h"
+#include "teach.h"
+#include "fields.h"
+#include "idle.h"
+#include "gov.h"
+#include "persist.h"
+#include "memguard.h"
 
 void setup() {
+  memguard_init();
   Serial.begin(BAUD_RATE);
-  delay(250); // avoid UNO R4 boot hang on Jetson
+  bool warm = persist_is_warm();
+  if (!warm) delay(COLD_BOOT_DELAY_MS); // avoid UNO R4 boot hang on Jetson
 
   pins_init();
   motion_init();
   servo_init();
   ultrasonic_init();
+  fields_init();
+  scan_init();
+  gaps_init();
+  follow_init();
+  teach_init();
   serial_proto_init();
   watchdog_init();
+  host_link_init();
   status_init();
+  battery_init();
+  idle_init();
+  gov_init();
+  persist_restore();
 
+  // BOOT,PHASE1[,BENCH],<COLD|WARM>,READY_MS=<ms since reset>
   #if BENCH_MODE
-  Serial.println("BOOT,PHASE1,BENCH");
+  Serial.print("BOOT,PHASE1,BENCH");
   #else
-  Serial.println("BOOT,PHASE1");
+  Serial.print("BOOT,PHASE1");
   #endif
+  Serial.print(warm ? ",WARM" : ",COLD");
+  Serial.print(",READY_MS="); Serial.println(millis());
+  memguard_arm();
 }
 
 void loop() {
+  idle_begin_pass();
+  gov_begin_pass();
+  host_link_tick();
   serial_proto_tick();
   watchdog_tick();
   servo_tick();
   ultrasonic_tick();
+  scan_tick();
+  follow_tick();
+  teach_tick();
   motion_tick();
   // In Bench Mode with silent default, status_tick will be a no-op unless verbosity is enabled
   status_tick();
+  battery_tick();
+  persist_tick();
+  gov_end_pass();
+  // Sleep until the next interrupt (RX, 1 ms tick, echo edge) if nothing is pending
+  idle_tick();
 }
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include "battery.h"
+#include "pins.h"
+#include "config.h"
+#include "motion.h"
+
+// Filters run in mV * 16 so the integer EMAs keep their low bits
+static uint32_t g_load_x16 = 0;  // tau ~ 16 samples: what the motors see
+static uint32_t g_fast_x16 = 0;  // tau ~ 4 samples: catches sag under bursts
+static uint32_t g_rest_x16 = 0;  // only updated while stopped and recovered
+static bool g_primed = false;
+static bool g_low = false;
+static uint16_t g_duty_permille = 1000;
+static unsigned long g_last_sample_ms = 0;
+static unsigned long g_stopped_since_ms = 0;
+static bool g_was_stopped = true;
+
+static uint16_t read_mv() {
+  uint32_t raw = (uint32_t)analogRead(BATT_SENSE);
+  uint32_t pin_mv = raw * BATT_ADC_REF_MV / ((1UL << BATT_ADC_BITS) - 1);
+  return (uint16_t)(pin_mv * (BATT_DIV_TOP_OHM + BATT_DIV_BOTTOM_OHM) / BATT_DIV_BOTTOM_OHM);
+}
+
+static bool present() {
+  return g_primed && (g_load_x16 >> 4) >= BATT_PRESENT_MV;
+}
+
+void battery_init() {
+  #if BATT_MONITOR
+  analogReadResolution(BATT_ADC_BITS);
+  uint32_t mv = read_mv();
+  g_load_x16 = g_fast_x16 = g_rest_x16 = mv << 4;
+  g_primed = true;
+  g_last_sample_ms = millis();
+  g_stopped_since_ms = g_last_sample_ms;
+  #endif
+}
+
+void battery_tick() {
+  #if BATT_MONITOR
+  unsigned long now = millis();
+  if (now - g_last_sample_ms < BATT_SAMPLE_MS) return;
+  g_last_sample_ms = now;
+
+  // A single conversion per pass; analogRead on the RA4M1 returns in a few us
+  uint32_t x16 = (uint32_t)read_mv() << 4;
+  g_load_x16 += ((int32_t)x16 - (int32_t)g_load_x16) / 16;
+  g_fast_x16 += ((int32_t)x16 - (int32_t)g_fast_x16) / 4;
+
+  bool stopped = (motion_get_mode() == MODE_STOP);
+  if (stopped && !g_was_stopped) g_stopped_since_ms = now;
+  g_was_stopped = stopped;
+  if (stopped && now - g_stopped_since_ms >= BATT_REST_SETTLE_MS) {
+    g_rest_x16 += ((int32_t)x16 - (int32_t)g_rest_x16) / 8;
+  }
+
+  if (!present()) { g_duty_permille = 1000; return; }
+  uint32_t mv = g_load_x16 >> 4;
+  g_duty_permille = (mv <= BATT_REF_MV) ? 1000 : (uint16_t)(1000UL * BATT_REF_MV / mv);
+
+  uint32_t rest = g_rest_x16 >> 4;
+  if (!g_low && rest < BATT_LOW_MV) {
+    g_low = true;
+    Serial.print("EVT bat=low mv="); Serial.println(rest);
+  } else if (g_low && rest > BATT_LOW_MV + 200) {
+    g_low = false;
+  }
+  #endif
+}
+
+uint16_t battery_mv() { return (uint16_t)(g_load_x16 >> 4); }
+
+uint16_t battery_sag_mv() {
+  if (g_was_stopped) return 0;
+  uint32_t rest = g_rest_x16 >> 4, fast = g_fast_x16 >> 4;
+  return rest > fast ? (uint16_t)(rest - fast) : 0;
+}
+
+uint8_t battery_duty_pct() { return (uint8_t)(g_duty_permille / 10); }
+
+uint16_t battery_duty_permille() { return g_duty_permille; }
+
+uint16_t battery_rest_mv() { return (uint16_t)(g_rest_x16 >> 4); }
+
+bool battery_present() { return present(); }
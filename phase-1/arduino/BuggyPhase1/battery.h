@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+void battery_init();
+void battery_tick();
+
+uint16_t battery_mv();      // filtered pack voltage under the present load
+uint16_t battery_sag_mv();  // rest voltage minus loaded voltage while driving
+uint8_t battery_duty_pct(); // compensation applied to the OE gate (100 = none)
+uint16_t battery_duty_permille(); // same, for the gate itself (1000 = none)
+
+uint16_t battery_rest_mv(); // pack voltage settled while stopped
+bool battery_present();     // a pack is connected and has been sampled
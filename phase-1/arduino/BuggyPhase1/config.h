@@ -1,5 +1,13 @@
 #pragma once
 
+// Optional buggy_tune output (phase_1_readme.md): a tuned_config.h next to this
+// file overrides the #ifndef-guarded knobs below
+#if defined(__has_include)
+#if __has_include("tuned_config.h")
+#include "tuned_config.h"
+#endif
+#endif
+
 #define BAUD_RATE 115200
 
 // Bench Mode vs Runtime Mode
@@ -21,22 +29,216 @@
 #define PWM_FAST 230
 #define PWM_SLOW 150
 
+// Static buffer sizes (bytes)
+#define CMD_LINE_MAX 63 // longest accepted command line; longer ones get ERR,TRUNC
+#define RX_RING_SIZE 256 // serial RX ring (power of two)
+
+// Drain serial RX from a periodic timer ISR into the ring (UNO R4 FspTimer)
+// while loop() blocks in pulseIn or a ToF wait; 0 or other cores drain only
+// from loop()
+#define SERIAL_RX_ISR 1
+#define SERIAL_RX_PUMP_HZ 2000 // 115200 baud = ~6 bytes per period
+#define CREDIT_REPORT 1        // emit CR credit lines as the RX ring drains
+#define CREDIT_MIN_MS 20       // batch CR lines to at most one per this interval
+
+// Heap-free build: any malloc/new after setup() traps (motors off, FAULT line,
+// halt). Allocations made by the core before that come from a static pool.
+// Our own sources may not name String/malloc at all (compile error).
+#ifndef HEAP_FREE
+#define HEAP_FREE 0
+#endif
+#define HEAP_BOOT_POOL_BYTES 512
+#define STACK_PAINT_MARGIN 64 // bytes left unpainted below SP at paint time
+
+// Servo trajectory (pulse range matches Servo.write() 0..180 mapping)
+#define SERVO_MIN_US 544
+#define SERVO_MAX_US 2400
+#define SERVO_MAX_VEL_DPS 300.0f   // deg/s
+#define SERVO_MAX_ACC_DPS2 3000.0f // deg/s^2
+
 // Timing (ms)
-#define SERVO_SETTLE_MS 100
-#define MEAS_COOLDOWN_MS 40
+#ifndef SERVO_SETTLE_MS
+#define SERVO_SETTLE_MS 40 // after the trajectory arrives (was 100 with step moves)
+#endif
 #define STAT_PERIOD_MS 250
+#define SAFETY_SAMPLE_MS 80    // background safety ping cadence (ADAPTIVE_PING 0)
+#ifndef SAFETY_DEFAULT_CM
+#define SAFETY_DEFAULT_CM 0    // boot-time T<n> safety threshold (0 = off until set)
+#endif
+#define ECHO_TIMEOUT_US 30000UL
+// Auto-resume after a safety stop: T<stop>,<resume>,<clear_ms>. The stopped
+// motion is held and re-applied once readings stay beyond <resume> for
+// <clear_ms>. A resume at or below the stop threshold keeps the old latch.
+#define SAFETY_RESUME_DEFAULT_CM 0 // 0 = latch (host must resend motion)
+#define SAFETY_CLEAR_DEFAULT_MS 300
+
+// Protective/warning fields (FLD,...): max range per angle sector, one table
+// pair per direction (forward, turning left/right) and speed tier. Sectors
+// split 0..180 deg evenly, right to left; 0 = no field in that sector. A
+// protective hit stops like T<n>; a warning hit caps the OE duty until the
+// next speed or mode command. OE is on/off, so tiers alone do not change speed.
+#define FIELDS_DEFAULT_ON 0
+#define FIELD_SECTORS 5        // 36 deg each: R, FR, C, FL, L
+#define FIELD_HITS 3           // consecutive samples inside a field before acting
+#define FIELD_FAST_DUTY_PCT 80 // applied OE duty at or above this selects the FAST tables
+#define FIELD_SLOW_DUTY_PCT 65 // warning-hit cap (~PWM_SLOW / PWM_FAST)
+//                      R  FR   C  FL   L
+#define FIELD_FF_STOP {  0, 25, 40, 25,  0 }
+#define FIELD_FF_WARN {  0, 45, 80, 45,  0 }
+#define FIELD_FS_STOP {  0, 12, 20, 12,  0 }
+#define FIELD_FS_WARN {  0, 25, 40, 25,  0 }
+#define FIELD_LF_STOP {  0,  0, 30, 35, 25 }
+#define FIELD_LF_WARN {  0,  0, 50, 60, 45 }
+#define FIELD_LS_STOP {  0,  0, 15, 20, 15 }
+#define FIELD_LS_WARN {  0,  0, 30, 35, 30 }
+#define FIELD_RF_STOP { 25, 35, 30,  0,  0 }
+#define FIELD_RF_WARN { 45, 60, 50,  0,  0 }
+#define FIELD_RS_STOP { 15, 20, 15,  0,  0 }
+#define FIELD_RS_WARN { 30, 35, 30,  0,  0 }
+
+// Continuous sweep (SWEEP,ON): constant-velocity pan with pings at a fixed
+// interval; each sample is tagged with the angle at the echo midpoint.
+#define SWEEP_RIGHT_DEG 45
+#define SWEEP_LEFT_DEG 135
+#define SWEEP_VEL_DPS 120.0f
+#define SWEEP_PING_MS 30       // > echo time at DIST_MAX_CM (~17 ms) + reverb
+#define SERVO_LAG_US 20000UL   // horn lags the commanded pulse by about one frame
+#define SERVO_LAG_UNC_US 10000UL
+#define SCAN_MAX_SAMPLES 48    // samples kept per sweep pass
+#define SCAN_FORMAT_DEFAULT 0  // 0 = SCN text per sample, 1 = one SCB binary line per pass
+
+// Adaptive ping spacing: the next ping waits for the last echo path plus the
+// room's reverberation tail instead of a fixed cadence. The tail estimate
+// creeps down on clean pings and jumps up on each ghost (AIMD).
+#define ADAPTIVE_PING 1           // 0 = fixed SAFETY_SAMPLE_MS / SWEEP_PING_MS
+#define PING_GAP_FLOOR_US 10000UL // never closer than this
+#define PING_NOECHO_HOLD_US 38000UL // HC-SR04 holds ECHO high this long with no echo
+#define REVERB_INIT_US 8000UL
+#define REVERB_MIN_US 2000UL
+#define REVERB_MAX_US 40000UL
+#define REVERB_STEP_US 4000UL     // raise per ghost or stray edge
+#define REVERB_DECAY_SHIFT 6      // clean ping shaves reverb/64
+#define GHOST_RATIO 0.6f          // reading below ratio*previous is a ghost suspect
+#define GHOST_CONFIRM_PCT 15      // two suspects within this agree = real obstacle
+#define SCB_ANGLE_FIT_CDEG 20  // max deviation for the fixed-angle-step encoding
+
+// Gap detection on each completed sweep pass (GAPS line)
+#define GAP_MIN_DEPTH_CM 60    // openings must be at least this deep
+#define GAP_MIN_WIDTH_CM 35    // chassis width + margin
+#define GAP_EDGE_JUMP_CM 40    // neighbour range step treated as an edge
+#define GAP_MAX 3              // gaps reported per frame
 
 // Heartbeat timeout derived from mode
+#ifndef HB_TIMEOUT_MS
 #if BENCH_MODE
 #define HB_TIMEOUT_MS 60000
 #else
 #define HB_TIMEOUT_MS 600
 #endif
+#endif
 
 // Pulsing knobs for ARC inner track (ms)
+#ifndef SLOW_PULSE_ON_MS
 #define SLOW_PULSE_ON_MS 40
+#endif
+#ifndef SLOW_PULSE_OFF_MS
 #define SLOW_PULSE_OFF_MS 15
+#endif
+
+// Scrub-reducing spin: front/rear axle alternation period (ms)
+#define SCRUB_PHASE_MS 60
+
+// Vision follow (FOLLOW,ON + VT updates): alpha-beta bearing prediction
+// between camera frames, PI steering, ultrasonic distance keeping.
+#define FOLLOW_DIST_CM 80        // default stand-off
+#define FOLLOW_TICK_MS 10        // controller period
+#define FOLLOW_GATE_MS 20        // per-side duty window (see motion_set_drive)
+#define FOLLOW_ALPHA 0.5f        // bearing correction gain
+#define FOLLOW_BETA 0.1f         // bearing-rate correction gain
+#define FOLLOW_PREDICT_MAX_MS 300 // extrapolate no further than this past an update
+#define FOLLOW_LOST_MS 600       // no VT for this long: wheels stop, EVT follow=lost
+#define FOLLOW_KP 0.02f          // turn duty per degree of bearing
+#define FOLLOW_KI 0.01f          // turn duty per degree-second
+#define FOLLOW_I_MAX 0.3f        // integral clamp (turn duty)
+#define FOLLOW_KD_CM 0.02f       // forward duty per cm beyond the stand-off
+#define FOLLOW_TURN_ONLY_DEG 30  // at this bearing error forward duty reaches 0
+#define FOLLOW_AIM_TOL_DEG 8     // servo must be this close to the bearing to trust the echo
+
+// Teach-and-repeat (REC,ON / REC,OFF / PLAY): motion changes logged in RAM,
+// 8 bytes per step; recording ends with EVT rec=full when the log is full
+#define TEACH_MAX_STEPS 128
+
+// Warm restart: keep thresholds/PWM override/servo target in no-init RAM and
+// skip the cold-boot settle delay when a valid record survives the reset.
+#define WARM_BOOT 1
+#define COLD_BOOT_DELAY_MS 250 // avoid UNO R4 boot hang on Jetson (cold power-up only)
+
+// Idle sleep: WFI at the end of each loop pass when nothing is pending.
+// Wake sources are serial RX, the 1 ms system tick and the echo edge IRQ,
+// so the sleep itself never exceeds one tick.
+#define IDLE_SLEEP 1
+#define IDLE_WAKE_BUDGET_US 250 // wake-to-handle latency above this counts as late
+
+// Loop-budget governor: tracks how long the pass in progress at a random
+// instant runs (busy time, weighted by itself, per GOV_WINDOW_MS). That is
+// how long motion, safety and the watchdog can be kept waiting. Over budget
+// it stretches periodic STAT, drops verbose/debug output and (at SHED)
+// postpones sweep-only ranging; those always still run every pass.
+#define GOV_ENABLE 1
+#define GOV_TARGET_US 5000UL   // pass budget; SHED at twice this
+#define GOV_WINDOW_MS 100
+#define GOV_EXIT_PCT 70        // step down once below this share of the entry level...
+#define GOV_HOLD_MS 500        // ...for this long
+#define GOV_STAT_STRETCH 4     // STAT_PERIOD_MS multiplier while over budget
+
+// Host disconnect: USB-CDC DTR drop stops the motors on the next loop pass.
+// The R4 WiFi's ESP32 bridge carries no line state; there (Runtime only) RX
+// silence for HOST_LINK_GAP_MS counts as a drop, ahead of HB_TIMEOUT_MS.
+#define HOST_LINK_DETECT 1
+#define HOST_RECONNECT_MS 100 // line must stay up this long before commands resume
+#define HOST_LINK_GAP_MS 450  // two missed 200 ms heartbeats plus slack
+
+// Ranging back-end (ranger.h). The safety stop, sweep, follow and telemetry
+// take samples from whichever one is compiled in.
+#define RANGER_HCSR04 0  // trigger/echo on A0/A1
+#define RANGER_VL53L0X 1 // I2C time-of-flight; needs the Pololu VL53L0X library
+#define RANGER_MOCK 2    // synthetic samples: host tests, bench without a sensor
+#ifndef RANGER_BACKEND
+#define RANGER_BACKEND RANGER_HCSR04
+#endif
+
+// Echo pin edge interrupt (non-blocking safety sampler, idle wake source)
+#define ULTRASONIC_ECHO_IRQ 1
+
+// VL53L0X: back-to-back continuous ranging, GPIO1 data-ready interrupt
+#define TOF_BUDGET_US 20000UL  // timing budget per sample (~50 Hz); longer = less noise
+#define TOF_IO_TIMEOUT_MS 50   // I2C transaction timeout inside the library
+#define TOF_I2C_HZ 400000UL
+
+// Mock back-end: one sample per period at a fixed range (host builds can
+// install their own source with ranger_mock_set_source())
+#define RANGER_MOCK_PERIOD_US 20000UL
+#define RANGER_MOCK_CM 100.0f
+
+// Motor battery: divider-scaled ADC sampling and duty compensation. The OE
+// line is gated at min(1, BATT_REF_MV / pack) so the tiers above give the
+// same effective motor voltage from a full pack down to BATT_REF_MV.
+#define BATT_MONITOR 1
+#define BATT_ADC_BITS 12
+#define BATT_ADC_REF_MV 5000
+#define BATT_DIV_TOP_OHM 20000UL    // pack -> A3
+#define BATT_DIV_BOTTOM_OHM 10000UL // A3 -> GND
+#define BATT_SAMPLE_MS 20           // one conversion per loop pass at this cadence
+#define BATT_REF_MV 6400            // voltage the PWM tiers were tuned at
+#define BATT_PRESENT_MV 3000        // below this the pack is absent (USB bench)
+#define BATT_LOW_MV 6000            // EVT bat=low (rest voltage)
+#define BATT_REST_SETTLE_MS 500     // after stopping, before the rest voltage is trusted
+#define BATT_GATE_PERIOD_US 10000UL // OE duty window, cut into SERIAL_RX_PUMP_HZ timer slots
 
 // Ultrasonic validity clamp (cm)
 #define DIST_MIN_CM 3
 #define DIST_MAX_CM 300
+
+#if HEAP_FREE && !defined(MEMGUARD_IMPL)
+#pragma GCC poison String malloc calloc realloc free
+#endif
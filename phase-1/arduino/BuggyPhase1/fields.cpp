@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <string.h>
+#include "fields.h"
+#include "motion.h"
+
+static bool g_on = false;
+static FieldTable g_table = {
+  { FIELD_FF_STOP, FIELD_FF_WARN }, { FIELD_FS_STOP, FIELD_FS_WARN },
+  { FIELD_LF_STOP, FIELD_LF_WARN }, { FIELD_LS_STOP, FIELD_LS_WARN },
+  { FIELD_RF_STOP, FIELD_RF_WARN }, { FIELD_RS_STOP, FIELD_RS_WARN },
+};
+static const char* const PROFILE_NAMES[FIELD_PROFILES] = { "FF", "FS", "LF", "LS", "RF", "RS" };
+
+void fields_init() {
+  g_on = FIELDS_DEFAULT_ON;
+}
+
+void fields_set_enabled(bool on) { g_on = on; }
+bool fields_enabled() { return g_on; }
+FieldTable* fields_table() { return &g_table; }
+
+const char* fields_profile_name(FieldProfile p) {
+  return p < FIELD_PROFILES ? PROFILE_NAMES[p] : "-";
+}
+
+// Travel direction of the current motion: 1 forward, 2 left, 3 right, 0 none.
+// The ranger faces forward, so reversing has nothing to protect with.
+static uint8_t travel_dir() {
+  switch (motion_get_mode()) {
+    case MODE_FORWARD_FAST: case MODE_FORWARD_SLOW:
+      return 1;
+    case MODE_ARC_LEFT: case MODE_SPIN_LEFT: case MODE_PIVOT_LEFT:
+    case MODE_FRONT_SPIN_LEFT: case MODE_REAR_SPIN_LEFT: case MODE_SCRUB_SPIN_LEFT:
+      return 2;
+    case MODE_ARC_RIGHT: case MODE_SPIN_RIGHT: case MODE_PIVOT_RIGHT:
+    case MODE_FRONT_SPIN_RIGHT: case MODE_REAR_SPIN_RIGHT: case MODE_SCRUB_SPIN_RIGHT:
+      return 3;
+    case MODE_WHEELS: {
+      int8_t w[4];
+      motion_get_wheels(w);
+      int left = w[0] + w[1], right = w[2] + w[3];
+      if (left > 0 && right > 0) return 1;
+      if (right > left && right > 0) return 2;
+      if (left > right && left > 0) return 3;
+      return 0; }
+    default:
+      return 0;
+  }
+}
+
+FieldProfile fields_profile() {
+  // Follow keeps its own distance; it only gets the creeping field
+  if (motion_get_mode() == MODE_FOLLOW) return FIELD_FS;
+  uint8_t dir = travel_dir();
+  if (dir == 0) return FIELD_NONE;
+  // By what OE actually applies: the PWM tiers alone do not change speed
+  bool fast = motion_duty_permille() >= FIELD_FAST_DUTY_PCT * 10;
+  return (FieldProfile)((dir - 1) * 2 + (fast ? 0 : 1));
+}
+
+bool fields_active() {
+  return g_on && fields_profile() != FIELD_NONE;
+}
+
+uint16_t fields_reach_cm() {
+  if (!g_on) return 0;
+  FieldProfile p = fields_profile();
+  if (p == FIELD_NONE) return 0;
+  uint16_t reach = 0;
+  for (uint8_t k = 0; k < 2; k++)
+    for (uint8_t s = 0; s < FIELD_SECTORS; s++) reach = max(reach, g_table[p][k][s]);
+  return reach;
+}
+
+uint8_t fields_sector(float deg) {
+  int s = (int)(deg * FIELD_SECTORS / 180.0f);
+  return (uint8_t)constrain(s, 0, FIELD_SECTORS - 1);
+}
+
+FieldLevel fields_check(FieldProfile p, float cm, float deg) {
+  if (p >= FIELD_PROFILES || isnan(cm)) return FIELD_CLEAR;
+  uint8_t s = fields_sector(deg);
+  uint16_t stop = g_table[p][0][s], warn = g_table[p][1][s];
+  if (stop && cm < (float)stop) return FIELD_STOP;
+  if (warn && cm < (float)warn) return FIELD_WARN;
+  return FIELD_CLEAR;
+}
+
+bool fields_command(const char* args) {
+  if (strcmp(args, "ON") == 0) { g_on = true; return true; }
+  if (strcmp(args, "OFF") == 0) { g_on = false; return true; }
+  // <prof>,<S|W>,<cm>,<cm>,... right to left
+  uint8_t p = 0;
+  while (p < FIELD_PROFILES && strncmp(args, PROFILE_NAMES[p], 2) != 0) p++;
+  if (p == FIELD_PROFILES || args[2] != ',' || (args[3] != 'S' && args[3] != 'W')) return false;
+  uint8_t kind = args[3] == 'S' ? 0 : 1;
+  uint16_t cm[FIELD_SECTORS];
+  const char* q = args + 4;
+  for (uint8_t s = 0; s < FIELD_SECTORS; s++) {
+    if (*q != ',') return false;
+    char* end;
+    long v = strtol(q + 1, &end, 10);
+    if (end == q + 1) return false;
+    cm[s] = (uint16_t)constrain(v, 0L, (long)DIST_MAX_CM);
+    q = end;
+  }
+  if (*q != '\0') return false;
+  memcpy(g_table[p][kind], cm, sizeof(cm));
+  return true;
+}
+
+static void print_row(const uint16_t* row) {
+  for (uint8_t s = 0; s < FIELD_SECTORS; s++) {
+    if (s) Serial.print(",");
+    Serial.print(row[s]);
+  }
+}
+
+void printFields() {
+  Serial.print("FLD on="); Serial.print(g_on ? 1 : 0);
+  Serial.print(" act="); Serial.print(fields_profile_name(g_on ? fields_profile() : FIELD_NONE));
+  for (uint8_t p = 0; p < FIELD_PROFILES; p++) {
+    Serial.print(" "); Serial.print(PROFILE_NAMES[p]); Serial.print("=");
+    print_row(g_table[p][0]);
+    Serial.print("/");
+    print_row(g_table[p][1]);
+  }
+  Serial.println();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Angular protective and warning fields. The active table pair follows the
+// current motion: direction (forward, turning left, turning right) and speed
+// tier by the OE duty applied (FIELD_FAST_DUTY_PCT). Stopped, reversing or unknown motion has no field.
+enum FieldProfile {
+  FIELD_FF = 0, // forward, fast
+  FIELD_FS,     // forward, slow
+  FIELD_LF,     // turning left, fast
+  FIELD_LS,
+  FIELD_RF,     // turning right, fast
+  FIELD_RS,
+  FIELD_PROFILES,
+  FIELD_NONE = FIELD_PROFILES
+};
+
+enum FieldLevel { FIELD_CLEAR = 0, FIELD_WARN, FIELD_STOP };
+
+void fields_init();
+void fields_set_enabled(bool on);
+bool fields_enabled();
+FieldProfile fields_profile();   // profile for the current motion
+bool fields_active();            // enabled and the current motion has a field
+uint16_t fields_reach_cm();       // farthest stop/warn edge of the active profile, 0 = none
+// Level of a range at a servo angle (deg, 90 = ahead) for profile p
+FieldLevel fields_check(FieldProfile p, float cm, float deg);
+uint8_t fields_sector(float deg);
+const char* fields_profile_name(FieldProfile p);
+
+// Raw table access for persist: [profile][0 = stop, 1 = warn][sector], cm
+typedef uint16_t FieldTable[FIELD_PROFILES][2][FIELD_SECTORS];
+FieldTable* fields_table();
+
+// FLD,ON | FLD,OFF | FLD,<prof>,<S|W>,<cm>x FIELD_SECTORS; false = malformed
+bool fields_command(const char* args);
+// FLD on= act=<prof|-> FF=<stop..>/<warn..> FS=... LF=... LS=... RF=... RS=...
+void printFields();
@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include "follow.h"
+#include "config.h"
+#include "motion.h"
+#include "servo_scan.h"
+#include "ultrasonic.h"
+
+static bool g_active = false;
+static uint16_t g_dist_cm = FOLLOW_DIST_CM;
+// Alpha-beta state, valid at g_est_ms
+static float g_b = 0.0f;        // deg, + = left
+static float g_rate = 0.0f;     // deg/s
+static unsigned long g_est_ms = 0;
+static bool g_have_fix = false;
+static bool g_lost = false;
+static float g_vt_cm = NAN;     // host range, if any
+static unsigned long g_vt_ms = 0;
+// PI / output
+static float g_integ = 0.0f;
+static float g_turn = 0.0f;
+static float g_fwd = 0.0f;
+static float g_used_cm = NAN;
+static unsigned long g_tick_ms = 0;
+static int g_aim_cdeg = -1;
+// FOL? window
+static unsigned long g_window_ms = 0;
+static uint16_t g_updates = 0;
+
+void follow_init() {
+  g_active = false;
+}
+
+void follow_start(uint16_t dist_cm) {
+  g_dist_cm = dist_cm ? dist_cm : FOLLOW_DIST_CM;
+  g_active = true;
+  g_have_fix = false;
+  g_lost = false;
+  g_integ = 0.0f;
+  g_aim_cdeg = -1;
+  servo_stopSweep();
+  motion_clear_pwm_speed(); // S leaves a zero override behind; follow sets its own duty
+  motion_set_drive(0.0f, 0.0f);
+  motion_set_mode(MODE_FOLLOW);
+  g_tick_ms = millis();
+}
+
+void follow_stop() {
+  if (!g_active) return;
+  g_active = false;
+  motion_set_drive(0.0f, 0.0f);
+  motion_set_mode(MODE_STOP);
+}
+
+bool follow_active() { return g_active; }
+uint16_t follow_dist_cm() { return g_active ? g_dist_cm : 0; }
+
+void follow_update(float bearing_deg, float range_cm, uint16_t age_ms) {
+  if (!g_active) return;
+  unsigned long now = millis();
+  unsigned long t_meas = now - age_ms;
+  g_updates++;
+  g_vt_cm = range_cm;
+  g_vt_ms = t_meas;
+  if (!g_have_fix || (long)(t_meas - g_est_ms) > FOLLOW_LOST_MS) {
+    g_b = bearing_deg;
+    g_rate = 0.0f;
+    g_est_ms = t_meas;
+    g_have_fix = true;
+    g_lost = false;
+    return;
+  }
+  long dt_ms = (long)(t_meas - g_est_ms);
+  if (dt_ms <= 0) return; // older than the estimate (reordered / jittered)
+  float dt = dt_ms / 1000.0f;
+  float pred = g_b + g_rate * dt;
+  float r = bearing_deg - pred;
+  g_b = pred + FOLLOW_ALPHA * r;
+  g_rate += FOLLOW_BETA * r / dt;
+  g_est_ms = t_meas;
+  g_lost = false;
+}
+
+// Bearing extrapolated to now, held after FOLLOW_PREDICT_MAX_MS
+static float predicted_bearing(unsigned long now) {
+  unsigned long ahead = now - g_est_ms;
+  if (ahead > FOLLOW_PREDICT_MAX_MS) ahead = FOLLOW_PREDICT_MAX_MS;
+  return g_b + g_rate * (ahead / 1000.0f);
+}
+
+static void aim_servo(float b) {
+  float deg = constrain(90.0f + b, (float)SWEEP_RIGHT_DEG, (float)SWEEP_LEFT_DEG);
+  int cdeg = (int)(deg * 100.0f);
+  if (g_aim_cdeg < 0 || abs(cdeg - g_aim_cdeg) >= 100) {
+    servo_set_target_cdeg(cdeg);
+    g_aim_cdeg = cdeg;
+  }
+}
+
+// Own echo when the horn is on target, else the host's range if recent
+static float target_range(float b) {
+  float aim = servo_get_position_cdeg() / 100.0f - 90.0f;
+  float cm = ultrasonic_last_cm();
+  if (!isnan(cm) && fabsf(aim - b) <= FOLLOW_AIM_TOL_DEG) return cm;
+  if (!isnan(g_vt_cm) && millis() - g_vt_ms <= FOLLOW_LOST_MS) return g_vt_cm;
+  return NAN;
+}
+
+void follow_tick() {
+  if (!g_active) return;
+  // Any other motion command (S, safety stop, watchdog) ends following
+  if (motion_get_mode() != MODE_FOLLOW) { g_active = false; return; }
+  unsigned long now = millis();
+  if (now - g_tick_ms < FOLLOW_TICK_MS) return;
+  float dt = (now - g_tick_ms) / 1000.0f;
+  g_tick_ms = now;
+
+  if (!g_have_fix || now - g_est_ms > FOLLOW_LOST_MS) {
+    if (g_have_fix && !g_lost) {
+      g_lost = true;
+      Serial.print("EVT follow=lost age_ms="); Serial.println(now - g_est_ms);
+    }
+    g_integ = 0.0f;
+    g_turn = g_fwd = 0.0f;
+    motion_set_drive(0.0f, 0.0f);
+    return;
+  }
+
+  float b = predicted_bearing(now);
+  aim_servo(b);
+
+  // PI on bearing (target straight ahead); integrate only while unsaturated
+  float p = FOLLOW_KP * b;
+  float turn = p + g_integ;
+  if (fabsf(turn) < 1.0f) {
+    g_integ = constrain(g_integ + FOLLOW_KI * b * dt, -FOLLOW_I_MAX, FOLLOW_I_MAX);
+  }
+  g_turn = constrain(p + g_integ, -1.0f, 1.0f);
+
+  // Close the stand-off gap, easing off while the target is well off-axis
+  g_used_cm = target_range(b);
+  float fwd = 0.0f;
+  if (!isnan(g_used_cm)) fwd = constrain(FOLLOW_KD_CM * (g_used_cm - g_dist_cm), 0.0f, 1.0f);
+  fwd *= constrain(1.0f - fabsf(b) / FOLLOW_TURN_ONLY_DEG, 0.0f, 1.0f);
+  g_fwd = fwd;
+
+  float l = fwd - g_turn, r = fwd + g_turn;
+  float m = max(1.0f, max(fabsf(l), fabsf(r)));
+  motion_set_drive(l / m, r / m);
+}
+
+void printFollow() {
+  unsigned long now = millis();
+  unsigned long span = now - g_window_ms;
+  float hz = span ? g_updates * 1000.0f / span : 0.0f;
+  Serial.print("FOL en="); Serial.print(g_active ? 1 : 0);
+  Serial.print(" b="); Serial.print(g_have_fix ? predicted_bearing(now) : 0.0f, 1);
+  Serial.print(" rate_dps="); Serial.print(g_rate, 1);
+  Serial.print(" turn="); Serial.print(g_turn, 2);
+  Serial.print(" fwd="); Serial.print(g_fwd, 2);
+  Serial.print(" cm="); if (isnan(g_used_cm)) Serial.print(-1); else Serial.print(g_used_cm, 1);
+  Serial.print(" age_ms="); Serial.print(g_have_fix ? now - g_est_ms : 0);
+  Serial.print(" upd_hz="); Serial.println(hz, 1);
+  g_window_ms = now;
+  g_updates = 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+
+// Vision-target following. The host sends timestamped bearings (and range if
+// it has one) at camera rate; between updates the bearing is extrapolated
+// with a constant-rate (alpha-beta) model and a PI loop steers at motor-loop
+// rate. The servo aims the ultrasonic at the target for distance keeping.
+void follow_init();
+void follow_tick();
+void follow_start(uint16_t dist_cm);
+void follow_stop();
+bool follow_active();
+uint16_t follow_dist_cm(); // stand-off while active, else 0
+
+// bearing: degrees, + = left (GAPS convention); range_cm NAN if unknown;
+// age_ms = capture-to-send latency on the host
+void follow_update(float bearing_deg, float range_cm, uint16_t age_ms);
+
+// FOL b= rate_dps= turn= fwd= cm= age_ms= upd_hz=
+void printFollow();
@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include "gaps.h"
+#include "config.h"
+
+static Gap g_gaps[GAP_MAX];
+static uint8_t g_count = 0;
+
+void gaps_init() { g_count = 0; }
+
+uint8_t gaps_get(const Gap** out) {
+  *out = g_gaps;
+  return g_count;
+}
+
+static float median3(float a, float b, float c) {
+  if (a > b) { float t = a; a = b; b = t; }
+  if (b > c) { b = c; }
+  return (a > b) ? a : b;
+}
+
+// Law of cosines: distance between two range returns dtheta apart
+static float chord_cm(float r1, float r2, float dtheta_deg) {
+  float c = cosf(dtheta_deg * DEG_TO_RAD);
+  float w2 = r1 * r1 + r2 * r2 - 2.0f * r1 * r2 * c;
+  return w2 > 0 ? sqrtf(w2) : 0.0f;
+}
+
+static void insert_ranked(const Gap& g, float score, float* scores) {
+  uint8_t i = g_count;
+  if (i == GAP_MAX) {
+    if (score <= scores[GAP_MAX - 1]) return;
+    i = GAP_MAX - 1;
+  } else {
+    g_count++;
+  }
+  while (i > 0 && scores[i - 1] < score) {
+    g_gaps[i] = g_gaps[i - 1];
+    scores[i] = scores[i - 1];
+    i--;
+  }
+  g_gaps[i] = g;
+  scores[i] = score;
+}
+
+void gaps_process(const ScanFrame* f) {
+  if (f == NULL || f->n < 3) return;
+  uint8_t n = f->n;
+
+  // Order by angle (the frame may run either way and jitter at the turnaround);
+  // no echo reads as open space out to DIST_MAX_CM
+  float ang[SCAN_MAX_SAMPLES];
+  float raw[SCAN_MAX_SAMPLES];
+  for (uint8_t i = 0; i < n; i++) {
+    float a = f->s[i].angle_cdeg / 100.0f;
+    float r = f->s[i].range_mm ? f->s[i].range_mm / 10.0f : (float)DIST_MAX_CM;
+    uint8_t j = i;
+    while (j > 0 && ang[j - 1] > a) { ang[j] = ang[j - 1]; raw[j] = raw[j - 1]; j--; }
+    ang[j] = a;
+    raw[j] = r;
+  }
+
+  // Smooth across neighbouring angles (median of 3 rejects single dropouts)
+  float rng[SCAN_MAX_SAMPLES];
+  rng[0] = raw[0];
+  rng[n - 1] = raw[n - 1];
+  for (uint8_t i = 1; i + 1 < n; i++) rng[i] = median3(raw[i - 1], raw[i], raw[i + 1]);
+
+  // A gap is a run of samples deeper than GAP_MIN_DEPTH_CM; it is bounded by
+  // shallower samples or a depth discontinuity > GAP_EDGE_JUMP_CM
+  float scores[GAP_MAX];
+  g_count = 0;
+  uint8_t i = 0;
+  while (i < n) {
+    if (rng[i] < GAP_MIN_DEPTH_CM) { i++; continue; }
+    uint8_t a = i;
+    float depth = rng[i];
+    while (i + 1 < n && rng[i + 1] >= GAP_MIN_DEPTH_CM &&
+           fabsf(rng[i + 1] - rng[i]) <= GAP_EDGE_JUMP_CM) {
+      i++;
+      if (rng[i] < depth) depth = rng[i];
+    }
+    uint8_t b = i;
+    i++;
+    // A run with a deeper neighbour is the shoulder of an opening, not one
+    if ((a > 0 && rng[a - 1] > depth) || (b + 1 < n && rng[b + 1] > depth)) continue;
+
+    // Edges: the obstacle just outside the run if there is one, else the run end
+    float r1 = (a > 0 && rng[a - 1] < rng[a]) ? rng[a - 1] : rng[a];
+    float r2 = (b + 1 < n && rng[b + 1] < rng[b]) ? rng[b + 1] : rng[b];
+    float a1 = (a > 0) ? 0.5f * (ang[a - 1] + ang[a]) : ang[a];
+    float a2 = (b + 1 < n) ? 0.5f * (ang[b] + ang[b + 1]) : ang[b];
+    float width = chord_cm(r1, r2, a2 - a1);
+    if (width < GAP_MIN_WIDTH_CM) continue;
+
+    Gap g;
+    float bearing = 0.5f * (a1 + a2) - 90.0f;
+    g.bearing_cdeg = (int16_t)(bearing * 100.0f);
+    g.width_cm = (uint16_t)(width + 0.5f);
+    g.depth_cm = (uint16_t)(depth + 0.5f);
+    // Prefer deep, wide openings close to the current heading
+    float w = width < 2.0f * GAP_MIN_WIDTH_CM ? width : 2.0f * GAP_MIN_WIDTH_CM;
+    float score = depth * w / (1.0f + fabsf(bearing) / 45.0f);
+    insert_ranked(g, score, scores);
+  }
+
+  Serial.print("GAPS seq="); Serial.print(f->seq);
+  Serial.print(" n="); Serial.print(g_count);
+  for (uint8_t k = 0; k < g_count; k++) {
+    Serial.print(" ");
+    Serial.print(g_gaps[k].bearing_cdeg / 100.0f, 1); Serial.print(",");
+    Serial.print(g_gaps[k].width_cm); Serial.print(",");
+    Serial.print(g_gaps[k].depth_cm);
+  }
+  Serial.println();
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <Arduino.h>
+#include "scan.h"
+
+// Passable opening found in a scan frame
+struct Gap {
+  int16_t bearing_cdeg; // centre of the opening; 0 = straight ahead, + = left
+  uint16_t width_cm;    // chord between the bounding edges
+  uint16_t depth_cm;    // nearest range inside the opening
+};
+
+void gaps_init();
+// Segment a completed frame and publish the ranked gaps:
+// GAPS seq=<n> n=<k> <bearing_deg>,<width_cm>,<depth_cm> ...
+void gaps_process(const ScanFrame* f);
+uint8_t gaps_get(const Gap** out); // last published list, best first
@@ -0,0 +1,87 @@
+#include <Arduino.h>
+#include "gov.h"
+#include "config.h"
+
+static GovLevel g_level = GOV_OK;
+static unsigned long g_pass_us = 0;     // start of the current pass
+static bool g_shed_pass = false;
+// Current window: sum(b) and sum(b^2) over the passes' busy times b
+static unsigned long g_win_ms = 0;
+static float g_win_sum = 0.0f;
+static float g_win_sq = 0.0f;
+static unsigned long g_loop_us = 0;     // smoothed time-weighted pass length
+static unsigned long g_under_ms = 0;    // below the exit level since, 0 = not
+// GOV? window
+static unsigned long g_max_us = 0;
+static uint32_t g_shed = 0;
+
+static const char* level_name(GovLevel l) {
+  switch (l) {
+    case GOV_LOAD: return "LOAD";
+    case GOV_SHED: return "SHED";
+    default: return "OK";
+  }
+}
+
+void gov_init() {
+  g_level = GOV_OK;
+  g_pass_us = micros();
+  g_win_ms = millis();
+}
+
+void gov_begin_pass() {
+  g_pass_us = micros();
+  g_shed_pass = false;
+}
+
+GovLevel gov_level() { return g_level; }
+
+void gov_note_shed() { g_shed_pass = true; }
+
+static void set_level(GovLevel l) {
+  g_level = l;
+  g_under_ms = 0;
+  Serial.print("EVT gov="); Serial.print(level_name(l));
+  Serial.print(" loop_us="); Serial.println(g_loop_us);
+}
+
+// Straight up to whatever the window calls for; down one level at a time,
+// and only after GOV_HOLD_MS comfortably under the level's entry point
+static void step(unsigned long now_ms) {
+  GovLevel want = g_loop_us > 2 * GOV_TARGET_US ? GOV_SHED : (g_loop_us > GOV_TARGET_US ? GOV_LOAD : GOV_OK);
+  if (want > g_level) { set_level(want); return; }
+  if (g_level == GOV_OK) return;
+  unsigned long entry = (g_level == GOV_SHED ? 2 : 1) * GOV_TARGET_US;
+  if (g_loop_us * 100UL >= entry * GOV_EXIT_PCT) { g_under_ms = 0; return; }
+  if (g_under_ms == 0) { g_under_ms = now_ms ? now_ms : 1; return; }
+  if (now_ms - g_under_ms >= GOV_HOLD_MS) set_level((GovLevel)(g_level - 1));
+}
+
+void gov_end_pass() {
+  unsigned long busy = micros() - g_pass_us;
+  if (busy > g_max_us) g_max_us = busy;
+  if (g_shed_pass) g_shed++;
+  g_win_sum += (float)busy;
+  g_win_sq += (float)busy * (float)busy;
+  unsigned long now = millis();
+  if (now - g_win_ms < GOV_WINDOW_MS) return;
+  // A long pass counts for as long as it ran, so one blocked ranging call
+  // among hundreds of short passes still shows
+  unsigned long win = g_win_sum > 0.0f ? (unsigned long)(g_win_sq / g_win_sum) : 0;
+  g_loop_us = (g_loop_us + win) / 2;
+  g_win_sum = g_win_sq = 0.0f;
+  g_win_ms = now;
+  #if GOV_ENABLE
+  step(now);
+  #endif
+}
+
+void printGov() {
+  Serial.print("GOV lvl="); Serial.print(level_name(g_level));
+  Serial.print(" loop_us="); Serial.print(g_loop_us);
+  Serial.print(" max_us="); Serial.print(g_max_us);
+  Serial.print(" target_us="); Serial.print(GOV_TARGET_US);
+  Serial.print(" shed="); Serial.println(g_shed);
+  g_max_us = 0;
+  g_shed = 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+// Loop-budget governor. Levels only ever shed optional work; nothing that
+// keeps the buggy safe is conditional on them.
+enum GovLevel {
+  GOV_OK = 0,  // under budget: everything runs
+  GOV_LOAD,    // loop time over GOV_TARGET_US: telemetry stretched, verbose/debug off
+  GOV_SHED     // over twice the budget: sweep-only ranging postponed as well
+};
+
+void gov_init();
+void gov_begin_pass(); // first in loop(), after idle_begin_pass()
+void gov_end_pass();   // last before idle_tick(); the sleep is not load
+GovLevel gov_level();
+void gov_note_shed();  // a skipped or postponed optional step (GOV? counter)
+
+// GOV lvl=<OK|LOAD|SHED> loop_us=<n> max_us=<n> target_us=<n> shed=<passes> (window resets)
+void printGov();
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "host_link.h"
+#include "config.h"
+#include "motion.h"
+#include "serial_rx.h"
+#include "watchdog.h"
+#include "teach.h"
+#include "ultrasonic.h"
+
+// Native USB-CDC boards see the host's DTR line state. The UNO R4 WiFi
+// reaches USB through the ESP32 bridge over a plain UART, so no line state
+// arrives; there the host counts as gone after HOST_LINK_GAP_MS without a
+// single RX byte (it heartbeats every 200 ms). Bench hosts need not send
+// heartbeats, so the gap check is Runtime-only.
+#define LINK_NONE 0
+#define LINK_DTR 1
+#define LINK_GAP 2
+#if !HOST_LINK_DETECT
+#define LINK_SENSE LINK_NONE
+#elif defined(ARDUINO_UNOR4_WIFI)
+#define LINK_SENSE (BENCH_MODE ? LINK_NONE : LINK_GAP)
+#else
+#define LINK_SENSE LINK_DTR
+#endif
+
+static bool g_up = true;
+static unsigned long g_up_seen_us = 0;   // last poll that saw the host
+static unsigned long g_down_ms = 0;      // when it went away
+static unsigned long g_lat_us = 0;       // last up sample -> stop issued
+static unsigned long g_return_ms = 0;    // line came back, waiting to settle
+static bool g_returning = false;
+#if LINK_SENSE == LINK_GAP
+static uint32_t g_rx_bytes = 0;          // bytes received as of g_rx_ms
+static unsigned long g_rx_ms = 0;
+#endif
+
+static bool line_up() {
+  #if LINK_SENSE == LINK_DTR
+  return (bool)Serial;
+  #elif LINK_SENSE == LINK_GAP
+  // Bytes ever received: taken off the link plus still queued in the ring
+  uint32_t rx = serial_rx_consumed_bytes() + (RX_RING_SIZE - serial_rx_free());
+  unsigned long ms = millis();
+  if (rx != g_rx_bytes) { g_rx_bytes = rx; g_rx_ms = ms; }
+  return ms - g_rx_ms < HOST_LINK_GAP_MS;
+  #else
+  return true;
+  #endif
+}
+
+void host_link_init() {
+  #if LINK_SENSE == LINK_GAP
+  g_rx_ms = millis();  // give the host a full gap to say hello
+  #endif
+  g_up = line_up();
+  g_up_seen_us = micros();
+}
+
+void host_link_tick() {
+  #if LINK_SENSE != LINK_NONE
+  bool now_up = line_up();
+  if (g_up) {
+    if (now_up) { g_up_seen_us = micros(); return; }
+    // Host closed the port or the cable went: stop before anything else runs
+    motion_emergency_stop();
+    teach_play_abort("host");
+    safety_hold_cancel();
+    g_lat_us = micros() - g_up_seen_us;
+    g_down_ms = millis();
+    g_up = false;
+    g_returning = false;
+    serial_rx_flush();
+    Serial.print("EVT stop=host lat_us="); Serial.println(g_lat_us); // lost with the DTR line
+    return;
+  }
+  if (!now_up) { g_returning = false; return; }
+  unsigned long ms = millis();
+  #if LINK_SENSE == LINK_DTR
+  if (!g_returning) { g_returning = true; g_return_ms = ms; return; }
+  if (ms - g_return_ms < HOST_RECONNECT_MS) return;
+  // Stable again: drop anything queued across the outage and start fresh
+  serial_rx_flush();
+  #else
+  // Traffic is what brought the link back; it is the new host's, keep it
+  g_return_ms = ms;
+  #endif
+  watchdog_note_hb();
+  g_up = true;
+  g_up_seen_us = micros();
+  #if BENCH_MODE
+  Serial.print("BOOT,PHASE1,BENCH,RECONNECT");
+  #else
+  Serial.print("BOOT,PHASE1,RECONNECT");
+  #endif
+  Serial.print(",READY_MS="); Serial.println(ms);
+  Serial.print("EVT host=up down_ms="); Serial.print(g_return_ms - g_down_ms);
+  Serial.print(" lat_us="); Serial.println(g_lat_us);
+  #endif
+}
+
+bool host_link_up() { return g_up; }
@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+
+// Host presence from the USB-CDC line state (DTR), or on the R4 WiFi's
+// ESP32 bridge from a gap in RX traffic. Losing the host stops the motors at
+// once, ahead of the heartbeat watchdog; its return flushes stale RX (DTR
+// only), re-arms the watchdog and re-announces the firmware.
+void host_link_init();
+void host_link_tick();
+bool host_link_up();
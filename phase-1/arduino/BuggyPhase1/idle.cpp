@@ -0,0 +1,77 @@
+#include <Arduino.h>
+#include "idle.h"
+#include "config.h"
+#include "ultrasonic.h"
+#include "serial_rx.h"
+
+static bool g_enabled = (IDLE_SLEEP != 0);
+static bool g_woke = false;
+static unsigned long g_wake_us = 0;
+// Stats window (since boot or last IDLE?)
+static unsigned long g_window_start_us = 0;
+static unsigned long g_slept_us = 0;
+static unsigned long g_sleeps = 0;
+static unsigned long g_wake_max_us = 0;
+static unsigned long g_late = 0;
+
+static void cpu_wait_for_interrupt() {
+  #if defined(__arm__)
+    __asm__ __volatile__("wfi");
+  #elif defined(HOST_BUILD)
+    host_wait_for_interrupt(); // virtual clock skips to the next wake source
+  #endif
+}
+
+void idle_init() {
+  g_window_start_us = micros();
+}
+
+void idle_begin_pass() {
+  if (!g_woke) return;
+  g_woke = false;
+  // Time from WFI return (ISR still pending) until the loop is back at the top
+  unsigned long lat = micros() - g_wake_us;
+  if (lat > g_wake_max_us) g_wake_max_us = lat;
+  if (lat > IDLE_WAKE_BUDGET_US) g_late++;
+}
+
+void idle_tick() {
+  if (!g_enabled) return;
+  unsigned long t0 = micros();
+  // Check and sleep with interrupts masked: a wake source that fires after the
+  // check stays pending and makes WFI return immediately instead of being lost.
+  noInterrupts();
+  if (serial_rx_pending() || Serial.available() > 0 || ultrasonic_echo_pending()) {
+    interrupts();
+    return;
+  }
+  serial_rx_sleep();
+  cpu_wait_for_interrupt();
+  unsigned long t1 = micros();
+  interrupts();
+  serial_rx_wake();
+
+  g_slept_us += t1 - t0;
+  g_sleeps++;
+  g_wake_us = t1;
+  g_woke = true;
+}
+
+void idle_set_enabled(bool on) { g_enabled = on; }
+bool idle_get_enabled() { return g_enabled; }
+
+void printIdle() {
+  unsigned long now = micros();
+  unsigned long span = now - g_window_start_us;
+  unsigned long pct = span ? (unsigned long)((100.0f * g_slept_us) / span) : 0;
+  Serial.print("IDLE en="); Serial.print(g_enabled ? 1 : 0);
+  Serial.print(" sleeps="); Serial.print(g_sleeps);
+  Serial.print(" idle_pct="); Serial.print(pct);
+  Serial.print(" wake_max_us="); Serial.print(g_wake_max_us);
+  Serial.print(" late="); Serial.println(g_late);
+  g_window_start_us = now;
+  g_slept_us = 0;
+  g_sleeps = 0;
+  g_wake_max_us = 0;
+  g_late = 0;
+}
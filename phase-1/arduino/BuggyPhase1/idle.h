@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+void idle_init();
+void idle_begin_pass(); // call first in loop(); closes the wake-latency measurement
+void idle_tick();       // call last in loop(); sleeps until the next interrupt
+
+void idle_set_enabled(bool on);
+bool idle_get_enabled();
+
+// IDLE en=<0|1> sleeps=<n> idle_pct=<0..100> wake_max_us=<n> late=<n> (window resets)
+void printIdle();
@@ -0,0 +1,116 @@
+#define MEMGUARD_IMPL
+#include <Arduino.h>
+#include <string.h>
+#include "memguard.h"
+#include "config.h"
+#include "pins.h"
+
+#define STACK_PAINT 0xC5u
+
+static bool g_armed = false;
+static uint32_t g_allocs = 0;
+
+// Stack bounds come from the RA (FSP) linker script; other targets skip painting
+#if defined(ARDUINO_ARCH_RENESAS)
+extern uint8_t __StackLimit;
+extern uint8_t __StackTop;
+#define STACK_BOTTOM (&__StackLimit)
+#define STACK_TOP (&__StackTop)
+#endif
+
+void memguard_init() {
+  #ifdef STACK_BOTTOM
+  uint8_t* end = (uint8_t*)__builtin_frame_address(0) - STACK_PAINT_MARGIN;
+  for (uint8_t* p = STACK_BOTTOM; p < end; p++) *p = STACK_PAINT;
+  #endif
+}
+
+uint32_t memguard_stack_size() {
+  #ifdef STACK_BOTTOM
+  return (uint32_t)(STACK_TOP - STACK_BOTTOM);
+  #else
+  return 0;
+  #endif
+}
+
+uint32_t memguard_stack_used() {
+  #ifdef STACK_BOTTOM
+  const uint8_t* p = STACK_BOTTOM;
+  while (p < STACK_TOP && *p == STACK_PAINT) p++;
+  return (uint32_t)(STACK_TOP - p);
+  #else
+  return 0;
+  #endif
+}
+
+#if HEAP_FREE
+static uint8_t g_pool[HEAP_BOOT_POOL_BYTES] __attribute__((aligned(8)));
+static size_t g_pool_used = 0;
+#endif
+
+void memguard_arm() { g_armed = true; }
+
+void printMem() {
+  Serial.print("MEM heap_free="); Serial.print(HEAP_FREE ? 1 : 0);
+  Serial.print(" pool=");
+  #if HEAP_FREE
+  Serial.print((unsigned long)g_pool_used); Serial.print("/"); Serial.print(HEAP_BOOT_POOL_BYTES);
+  #else
+  Serial.print("0/0");
+  #endif
+  Serial.print(" allocs="); Serial.print(g_allocs);
+  Serial.print(" stack_used="); Serial.print(memguard_stack_used());
+  Serial.print(" stack_size="); Serial.println(memguard_stack_size());
+}
+
+#if HEAP_FREE
+// Replaces the C library allocator for the whole image: pre-arm requests bump
+// from g_pool and are never released; post-arm requests are a fault.
+static void heap_trap(const char* op, size_t n) {
+  digitalWrite(SR_OE, HIGH); // disable all motor outputs (active-LOW OE)
+  Serial.print("FAULT heap op="); Serial.print(op);
+  Serial.print(" n="); Serial.println((unsigned long)n);
+  Serial.flush();
+  for (;;) {}
+}
+
+static void* pool_alloc(size_t n) {
+  size_t need = (n + 7u) & ~(size_t)7u;
+  if (g_pool_used + need > sizeof(g_pool)) return NULL;
+  void* p = g_pool + g_pool_used;
+  g_pool_used += need;
+  return p;
+}
+
+extern "C" {
+void* malloc(size_t n) {
+  if (g_armed) heap_trap("malloc", n);
+  g_allocs++;
+  return pool_alloc(n);
+}
+void* calloc(size_t count, size_t n) {
+  if (g_armed) heap_trap("calloc", count * n);
+  g_allocs++;
+  void* p = pool_alloc(count * n);
+  if (p) memset(p, 0, count * n);
+  return p;
+}
+void* realloc(void* old, size_t n) {
+  if (g_armed) heap_trap("realloc", n);
+  g_allocs++;
+  // Pool blocks carry no size; only realloc(NULL, n) is supported pre-arm
+  if (old != NULL) heap_trap("realloc", n);
+  return pool_alloc(n);
+}
+void free(void* p) {
+  if (p != NULL && g_armed) heap_trap("free", 0);
+}
+}
+
+void* operator new(size_t n) { return malloc(n); }
+void* operator new[](size_t n) { return malloc(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+// Stack painting + heap policy (HEAP_FREE in config.h)
+void memguard_init(); // first thing in setup(): paint the free stack
+void memguard_arm();  // last thing in setup(): heap allocations trap from here on
+
+uint32_t memguard_stack_size();
+uint32_t memguard_stack_used(); // high-water mark from paint; 0 if unsupported
+
+// MEM heap_free=<0|1> pool=<used>/<size> allocs=<n> stack_used=<n> stack_size=<n>
+void printMem();
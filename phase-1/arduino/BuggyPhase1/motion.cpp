@@ -1,13 +1,22 @@
 #include <Arduino.h>
 #include "motion.h"
+#include "battery.h"
 #include "pins.h"
 #include "config.h"
 
-static MotionMode g_mode = MODE_STOP;
+static volatile MotionMode g_mode = MODE_STOP;
+static volatile uint8_t g_estop_seq = 0; // bumped by every ISR-side stop
 static int g_left_pwm = 0;
 static int g_right_pwm = 0;
 static unsigned long g_pulse_ms = 0;
 static int g_pwm_override = -1; // -1 = none; else 0..255
+static int8_t g_wheels[4] = { 0, 0, 0, 0 }; // MODE_WHEELS pattern
+// OE duty wanted by the last tick, permille of the gate window; 0 = outputs off
+static volatile uint16_t g_oe_permille = 0;
+static uint8_t g_gate_slot = 0;
+static bool g_gate_timer = false; // motion_gate_isr() is being called
+static uint16_t g_duty_limit = 1000; // motion_limit_duty(), 1000 = none
+static float g_drive[2] = { 0.0f, 0.0f };   // MODE_FOLLOW left/right duty
 
 // 74HC595 shift register state
 static uint8_t g_latch_state = 0x00;
@@ -47,9 +56,36 @@ void motion_init() {
 void motion_set_mode(MotionMode mode) {
   if (g_mode != mode) {
     g_mode = mode;
+    g_duty_limit = 1000;
   }
 }
 
+void motion_emergency_stop() {
+  g_mode = MODE_STOP;
+  g_estop_seq++;
+  g_oe_permille = 0; // keeps the gate ISR from switching them back on
+  digitalWrite(SR_OE, HIGH); // active-LOW: all motor outputs off
+}
+
+#define GATE_SLOTS (BATT_GATE_PERIOD_US * SERIAL_RX_PUMP_HZ / 1000000UL)
+
+void motion_gate_isr() {
+  uint16_t d = g_oe_permille;
+  if (d == 0 || d >= 1000) return; // fully off/on: written by motion_tick
+  if (++g_gate_slot >= GATE_SLOTS) g_gate_slot = 0;
+  uint32_t on = ((uint32_t)d * GATE_SLOTS + 500UL) / 1000UL;
+  digitalWrite(SR_OE, g_gate_slot < on ? LOW : HIGH);
+}
+
+void motion_gate_timer(bool running) { g_gate_timer = running; }
+
+bool motion_gate_chopping() {
+  uint16_t d = g_oe_permille;
+  return d > 0 && d < 1000;
+}
+
+uint8_t motion_estop_seq() { return g_estop_seq; }
+
 MotionMode motion_get_mode() { return g_mode; }
 
 const char* motion_mode_name(MotionMode m) {
@@ -62,6 +98,16 @@ const char* motion_mode_name(MotionMode m) {
     case MODE_ARC_RIGHT: return "ARC_R";
     case MODE_SPIN_LEFT: return "SPIN_L";
     case MODE_SPIN_RIGHT: return "SPIN_R";
+    case MODE_PIVOT_LEFT: return "PIVOT_L";
+    case MODE_PIVOT_RIGHT: return "PIVOT_R";
+    case MODE_FRONT_SPIN_LEFT: return "FSPIN_L";
+    case MODE_FRONT_SPIN_RIGHT: return "FSPIN_R";
+    case MODE_REAR_SPIN_LEFT: return "RSPIN_L";
+    case MODE_REAR_SPIN_RIGHT: return "RSPIN_R";
+    case MODE_SCRUB_SPIN_LEFT: return "XSPIN_L";
+    case MODE_SCRUB_SPIN_RIGHT: return "XSPIN_R";
+    case MODE_WHEELS: return "WHEELS";
+    case MODE_FOLLOW: return "FOLLOW";
   }
   return "UNKNOWN";
 }
@@ -70,6 +116,48 @@ int motion_left_pwm() { return g_left_pwm; }
 int motion_right_pwm() { return g_right_pwm; }
 int motion_get_pwm_override() { return g_pwm_override; }
 
+void motion_set_wheels(const int8_t dir[4]) {
+  for (uint8_t m = 0; m < 4; m++) g_wheels[m] = (dir[m] > 0) ? 1 : (dir[m] < 0 ? -1 : 0);
+}
+
+void motion_get_wheels(int8_t dir[4]) {
+  for (uint8_t m = 0; m < 4; m++) dir[m] = g_wheels[m];
+}
+
+void motion_set_drive(float left, float right) {
+  g_drive[0] = constrain(left, -1.0f, 1.0f);
+  g_drive[1] = constrain(right, -1.0f, 1.0f);
+}
+
+static void set_wheels(int8_t w[4], int8_t fl, int8_t rl, int8_t rr, int8_t fr) {
+  w[0] = fl; w[1] = rl; w[2] = rr; w[3] = fr;
+}
+
+// Per-wheel patterns for the individually commanded modes; false = paired mode
+static bool wheel_pattern(MotionMode m, unsigned long now, int8_t w[4]) {
+  switch (m) {
+    case MODE_PIVOT_LEFT: set_wheels(w, 0, 0, +1, +1); return true;
+    case MODE_PIVOT_RIGHT: set_wheels(w, +1, +1, 0, 0); return true;
+    case MODE_FRONT_SPIN_LEFT: set_wheels(w, -1, 0, 0, +1); return true;
+    case MODE_FRONT_SPIN_RIGHT: set_wheels(w, +1, 0, 0, -1); return true;
+    case MODE_REAR_SPIN_LEFT: set_wheels(w, 0, -1, +1, 0); return true;
+    case MODE_REAR_SPIN_RIGHT: set_wheels(w, 0, +1, -1, 0); return true;
+    case MODE_SCRUB_SPIN_LEFT:
+    case MODE_SCRUB_SPIN_RIGHT: {
+      // Only one axle pushes at a time; the other coasts instead of being
+      // dragged sideways, which cuts tyre scrub on high-grip floors
+      int8_t d = (m == MODE_SCRUB_SPIN_LEFT) ? +1 : -1;
+      bool front = ((now / SCRUB_PHASE_MS) & 1u) == 0;
+      if (front) set_wheels(w, -d, 0, 0, d); else set_wheels(w, 0, -d, d, 0);
+      return true; }
+    case MODE_WHEELS:
+      for (uint8_t i = 0; i < 4; i++) w[i] = g_wheels[i];
+      return true;
+    default:
+      return false;
+  }
+}
+
 void motion_tick() {
   // Decide directions and conceptual per-side speeds
   int dirL = 0, dirR = 0;
@@ -77,7 +165,10 @@ void motion_tick() {
   // Global OE speed tier (one for all motors, inverted on OE)
   int global_pwm = 0;
 
-  switch (g_mode) {
+  // The RX ISR may force STOP mid-tick; the OE write below checks for that
+  uint8_t seq = g_estop_seq;
+  MotionMode mode = g_mode;
+  switch (mode) {
     case MODE_STOP:
       dirL = dirR = 0; pwmL = pwmR = 0; global_pwm = 0; break;
     case MODE_FORWARD_FAST:
@@ -94,6 +185,18 @@ void motion_tick() {
       dirL = -1; dirR = +1; pwmL = PWM_SLOW; pwmR = PWM_SLOW; global_pwm = PWM_SLOW; break;
     case MODE_SPIN_RIGHT:
       dirL = +1; dirR = -1; pwmL = PWM_SLOW; pwmR = PWM_SLOW; global_pwm = PWM_SLOW; break;
+    case MODE_PIVOT_LEFT:
+      pwmL = 0; pwmR = PWM_SLOW; global_pwm = PWM_SLOW; break;
+    case MODE_PIVOT_RIGHT:
+      pwmL = PWM_SLOW; pwmR = 0; global_pwm = PWM_SLOW; break;
+    case MODE_FRONT_SPIN_LEFT: case MODE_FRONT_SPIN_RIGHT:
+    case MODE_REAR_SPIN_LEFT: case MODE_REAR_SPIN_RIGHT:
+    case MODE_SCRUB_SPIN_LEFT: case MODE_SCRUB_SPIN_RIGHT:
+    case MODE_WHEELS:
+      pwmL = pwmR = PWM_SLOW; global_pwm = PWM_SLOW; break;
+    case MODE_FOLLOW:
+      pwmL = (int)(fabsf(g_drive[0]) * PWM_FAST); pwmR = (int)(fabsf(g_drive[1]) * PWM_FAST);
+      global_pwm = PWM_FAST; break;
   }
 
   // Apply explicit override if present
@@ -104,7 +207,26 @@ void motion_tick() {
   // IMPORTANT: Use digitalWrite (not analogWrite) to avoid timer conflicts with Servo library
   // The Servo library on UNO R4 uses the same timer as analogWrite on pin 7 (SR_OE)
   // This loses smooth PWM speed control, but allows servo to function
-    digitalWrite(SR_OE, (global_pwm > 0) ? LOW : HIGH);
+  // Battery compensation chops OE in software instead: on the pump timer's
+  // slots when it runs, else here once per pass (good while passes stay well
+  // under BATT_GATE_PERIOD_US, which the governor keeps an eye on)
+  uint16_t duty = global_pwm > 0 ? (uint16_t)((uint32_t)battery_duty_permille() * g_duty_limit / 1000UL) : 0;
+  bool chop = duty > 0 && duty < 1000;
+  noInterrupts();
+  if (seq != g_estop_seq) {
+    // An urgent stop landed after mode was read: keep its outputs off and
+    // let the next tick apply STOP
+    interrupts();
+    return;
+  }
+  g_oe_permille = duty;
+  if (!chop) {
+    digitalWrite(SR_OE, duty ? LOW : HIGH);
+  } else if (!g_gate_timer) {
+    bool on = (micros() % BATT_GATE_PERIOD_US) < (BATT_GATE_PERIOD_US / 1000UL) * duty;
+    digitalWrite(SR_OE, on ? LOW : HIGH);
+  }
+  interrupts();
 
   // Pulse-gate sides that should be "slow" under a FAST global tier (arcs)
   unsigned long now = millis();
@@ -130,8 +252,23 @@ void motion_tick() {
     }
   };
 
-  drive_side(true, pwmL, dirL);
-  drive_side(false, pwmR, dirR);
+  // Time-proportional gate: on for |duty| of each FOLLOW_GATE_MS window
+  auto gate = [&](float duty) -> int {
+    if ((float)(now % FOLLOW_GATE_MS) >= fabsf(duty) * FOLLOW_GATE_MS) return 0;
+    return duty > 0.0f ? +1 : -1;
+  };
+
+  int8_t wheels[4];
+  if (mode == MODE_FOLLOW) {
+    int l = gate(g_drive[0]), r = gate(g_drive[1]);
+    set_motor_dir(0, l); set_motor_dir(1, l);
+    set_motor_dir(2, r); set_motor_dir(3, r);
+  } else if (wheel_pattern(mode, now, wheels)) {
+    for (uint8_t m = 0; m < 4; m++) set_motor_dir(m, wheels[m]);
+  } else {
+    drive_side(true, pwmL, dirL);
+    drive_side(false, pwmR, dirR);
+  }
 
   g_left_pwm = pwmL;
   g_right_pwm = pwmR;
@@ -139,9 +276,19 @@ void motion_tick() {
 
 void motion_pwm_speed(uint8_t pwm) {
   g_pwm_override = (int)pwm;
+  g_duty_limit = 1000;
 }
 void motion_clear_pwm_speed() {
   g_pwm_override = -1;
+  g_duty_limit = 1000;
+}
+
+void motion_limit_duty(uint16_t permille) {
+  g_duty_limit = permille < 1000 ? permille : 1000;
+}
+
+uint16_t motion_duty_permille() {
+  return motion_get_global_pwm() > 0 ? g_duty_limit : 0;
 }
 int motion_get_global_pwm() {
   // Return last applied global PWM value (override wins during tick)
@@ -154,6 +301,9 @@ int motion_get_global_pwm() {
     case MODE_ARC_RIGHT: return PWM_FAST;
     case MODE_SPIN_LEFT: return PWM_SLOW;
     case MODE_SPIN_RIGHT: return PWM_SLOW;
-    default: return 0;
+    case MODE_STOP: return 0;
+    case MODE_FOLLOW: return PWM_FAST;
+    default: return PWM_SLOW; // per-wheel modes
+
   }
 }
@@ -9,19 +9,53 @@ enum MotionMode {
   MODE_ARC_LEFT,
   MODE_ARC_RIGHT,
   MODE_SPIN_LEFT,
-  MODE_SPIN_RIGHT
+  MODE_SPIN_RIGHT,
+  // Individually commanded wheels (M1 FL, M2 RL, M3 RR, M4 FR)
+  MODE_PIVOT_LEFT,        // left pair held, right pair forward: turn about the left wheels
+  MODE_PIVOT_RIGHT,
+  MODE_FRONT_SPIN_LEFT,   // front axle only, rear wheels coast
+  MODE_FRONT_SPIN_RIGHT,
+  MODE_REAR_SPIN_LEFT,    // rear axle only, front wheels coast
+  MODE_REAR_SPIN_RIGHT,
+  MODE_SCRUB_SPIN_LEFT,   // alternate front/rear axle every SCRUB_PHASE_MS
+  MODE_SCRUB_SPIN_RIGHT,
+  MODE_WHEELS,            // raw per-wheel directions from motion_set_wheels()
+  MODE_FOLLOW             // per-side signed duty from motion_set_drive() (vision follow)
 };
 
 void motion_init();
 void motion_set_mode(MotionMode mode);
+void motion_emergency_stop(); // ISR-safe: outputs off now, STOP applied next tick
+uint8_t motion_estop_seq();    // changes whenever an ISR stops the motors (seqlock readers)
 MotionMode motion_get_mode();
 void motion_tick();
+// OE chopping for a partial duty (battery compensation). With the RX pump
+// timer running, motion_gate_isr() cuts each BATT_GATE_PERIOD_US window on
+// its fixed slots; without it motion_tick() samples the window once per pass.
+void motion_gate_isr();
+void motion_gate_timer(bool running);
+bool motion_gate_chopping(); // a partial duty is being cut: the timer must keep running
 const char* motion_mode_name(MotionMode m);
 int motion_left_pwm();
 int motion_right_pwm();
 
+// Per-wheel directions for MODE_WHEELS: -1 = reverse, 0 = hold, +1 = forward
+// Order follows the motor numbering: {FL (M1), RL (M2), RR (M3), FR (M4)}
+void motion_set_wheels(const int8_t dir[4]);
+void motion_get_wheels(int8_t dir[4]);
+
+// Per-side signed duty for MODE_FOLLOW, -1..1 each (+ = forward). With only a
+// global OE, each side is time-gated over FOLLOW_GATE_MS to reach its duty.
+void motion_set_drive(float left, float right);
+
 // Explicit OE PWM override for compact commands (0–255); -1 clears override
 void motion_pwm_speed(uint8_t pwm);
 void motion_clear_pwm_speed();
 int motion_get_pwm_override();
 int motion_get_global_pwm();
+
+// Temporary cap on the OE duty, permille, under the tiers (warning field).
+// The next speed or mode command lifts it.
+void motion_limit_duty(uint16_t permille);
+// OE duty the motors get before battery compensation, permille; 0 = stopped
+uint16_t motion_duty_permille();
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "persist.h"
+#include "config.h"
+#include "motion.h"
+#include "servo_scan.h"
+#include "ultrasonic.h"
+#include "status.h"
+#include "idle.h"
+#include "fields.h"
+
+#define PERSIST_MAGIC 0xB0661E03UL
+
+struct PersistState {
+  uint32_t magic;
+  uint16_t warm_boots;
+  uint16_t safety_cm;
+  uint16_t resume_cm;
+  uint16_t clear_ms;
+  int16_t pwm_override; // -1 = none
+  int16_t servo_deg;
+  uint8_t verbose;
+  uint8_t idle;
+  uint8_t fields_on;
+  uint8_t pad;
+  FieldTable fields;
+  uint32_t check;
+};
+
+#if defined(__arm__)
+static PersistState g_ps __attribute__((section(".noinit")));
+#else
+static PersistState g_ps; // no .noinit on host builds: always cold
+#endif
+static bool g_warm = false;
+static bool g_checked = false;
+
+static uint32_t checksum(const PersistState& s) {
+  // FNV-1a over everything but the check word
+  const uint8_t* p = (const uint8_t*)&s;
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < offsetof(PersistState, check); i++) { h ^= p[i]; h *= 16777619UL; }
+  return h;
+}
+
+static void seal() {
+  g_ps.magic = PERSIST_MAGIC;
+  g_ps.check = checksum(g_ps);
+}
+
+bool persist_is_warm() {
+  if (!g_checked) {
+    g_checked = true;
+    g_warm = WARM_BOOT && g_ps.magic == PERSIST_MAGIC && g_ps.check == checksum(g_ps);
+  }
+  return g_warm;
+}
+
+void persist_restore() {
+  if (persist_is_warm()) {
+    setSafetyThresholdCM(g_ps.safety_cm);
+    setSafetyResume(g_ps.resume_cm, g_ps.clear_ms);
+    if (g_ps.pwm_override >= 0) motion_pwm_speed((uint8_t)g_ps.pwm_override);
+    servo_set_target_deg(g_ps.servo_deg);
+    status_set_verbose(g_ps.verbose != 0);
+    idle_set_enabled(g_ps.idle != 0);
+    fields_set_enabled(g_ps.fields_on != 0);
+    memcpy(fields_table(), &g_ps.fields, sizeof(FieldTable));
+    if (g_ps.warm_boots < 0xFFFF) g_ps.warm_boots++;
+  } else {
+    memset(&g_ps, 0, sizeof(g_ps));
+  }
+  // Motion mode is never restored: every boot starts in STOP
+  persist_tick();
+  seal();
+}
+
+void persist_tick() {
+  uint16_t safety = getSafetyThresholdCM();
+  uint16_t resume = getSafetyResumeCM();
+  uint16_t clear = getSafetyClearMs();
+  int16_t pwm = (int16_t)motion_get_pwm_override();
+  int16_t deg = (int16_t)servo_get_target_deg();
+  uint8_t verbose = status_get_verbose() ? 1 : 0;
+  uint8_t idle = idle_get_enabled() ? 1 : 0;
+  uint8_t fields_on = fields_enabled() ? 1 : 0;
+  if (safety == g_ps.safety_cm && resume == g_ps.resume_cm && clear == g_ps.clear_ms && pwm == g_ps.pwm_override && deg == g_ps.servo_deg &&
+      verbose == g_ps.verbose && idle == g_ps.idle && fields_on == g_ps.fields_on &&
+      memcmp(fields_table(), &g_ps.fields, sizeof(FieldTable)) == 0) return;
+  g_ps.safety_cm = safety;
+  g_ps.resume_cm = resume;
+  g_ps.clear_ms = clear;
+  g_ps.pwm_override = pwm;
+  g_ps.servo_deg = deg;
+  g_ps.verbose = verbose;
+  g_ps.idle = idle;
+  g_ps.fields_on = fields_on;
+  memcpy(&g_ps.fields, fields_table(), sizeof(FieldTable));
+  seal();
+}
+
+uint16_t persist_warm_boots() { return g_ps.warm_boots; }
@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+
+// Runtime state kept in no-init RAM across soft resets (pin reset, USB reset).
+// A cold power-up fails the magic/checksum test and boots with defaults.
+bool persist_is_warm();   // valid saved state found (call before module init)
+void persist_restore();   // re-apply saved state (call after module init)
+void persist_tick();      // re-seal the record when any tracked value changes
+uint16_t persist_warm_boots();
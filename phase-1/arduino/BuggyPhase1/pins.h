@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "config.h"
 
 // 74HC595 + L293D shield mapping (global OE for speed; PWM is inverted)
 // SER=D8, CLK=D4, LATCH=D12, OE=D7 (active-LOW)
@@ -22,6 +23,13 @@
 #define ULTRASONIC_TRIG A0
 #define ULTRASONIC_ECHO A1
 
+// VL53L0X time-of-flight (RANGER_VL53L0X): SDA/SCL on the R4's I2C header,
+// GPIO1 (data ready, active-LOW) on an interrupt-capable pin the shield leaves free
+#define TOF_GPIO1 2
+
+// Motor pack voltage through a resistor divider (see BATT_DIV_* in config.h)
+#define BATT_SENSE A3
+
 // Servo signal (detach when idle)
 #define SERVO_PIN 10
 
@@ -62,7 +70,9 @@ inline void pins_init() {
     analogWrite(SR_OE, 0); // fully enabled (PWM available in Runtime)
   #endif
 
+  #if RANGER_BACKEND == RANGER_HCSR04
   pinMode(ULTRASONIC_TRIG, OUTPUT);
   digitalWrite(ULTRASONIC_TRIG, LOW);
   pinMode(ULTRASONIC_ECHO, INPUT);
+  #endif
 }
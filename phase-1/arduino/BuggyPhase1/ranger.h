@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Ranging back-end: owns the sensor and hands completed samples to
+// ultrasonic.cpp, which runs the safety stop, sweep, follow and telemetry on
+// them. Exactly one is compiled in (RANGER_BACKEND in config.h).
+struct RangeSample {
+  float cm;              // NAN = nothing usable (see blind)
+  unsigned long mid_us;  // moment the range describes (echo or integration midpoint)
+  unsigned long span_us; // time the sample took to form; the horn keeps moving meanwhile
+  bool blind;            // a return inside DIST_MIN_CM: too close to measure, not clear
+};
+
+void ranger_init();
+// Background sampling at the back-end's own pace; true once per completed sample
+bool ranger_poll(RangeSample* out, bool sweeping);
+void ranger_stop();                          // nothing needs background samples
+bool ranger_ready();                         // a completed sample waits (idle wake test)
+// One sample for PING, blocking for at most one measurement. false = too soon
+// after the last one (the caller keeps its previous value)
+bool ranger_measure(RangeSample* out);
+unsigned long ranger_gap_us(bool sweeping);  // current sample spacing
+void ranger_print_stats();                   // back-end fields for the RNG line
+const char* ranger_name();
+
+#if RANGER_BACKEND == RANGER_MOCK
+// Range source for the mock: cm at the given time, NAN = nothing in range
+typedef float (*RangerMockSource)(unsigned long now_us);
+void ranger_mock_set_source(RangerMockSource fn); // NULL = RANGER_MOCK_CM
+#endif
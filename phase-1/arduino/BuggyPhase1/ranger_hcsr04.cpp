@@ -0,0 +1,242 @@
+#include <Arduino.h>
+#include "ranger.h"
+
+#if RANGER_BACKEND == RANGER_HCSR04
+#include "pins.h"
+#include "gov.h"
+#include "fields.h"
+#include "follow.h"
+#include "ultrasonic.h"
+#include "serial_rx.h"
+
+// Ping spacing: every trigger (background or PING) goes through note_trigger()
+static unsigned long g_last_trig_us = 0;
+static unsigned long g_last_dur_us = 0;   // echo time of the last ping, 0 = none
+static unsigned long g_reverb_us = REVERB_INIT_US;
+static float g_prev_cm = NAN;             // last accepted reading (ghost reference)
+static float g_suspect_cm = NAN;          // short reading awaiting confirmation
+static uint32_t g_ghosts = 0;
+
+// Echo edge capture (ISR-owned); also wakes the idle loop
+static volatile unsigned long g_echo_rise_us = 0;
+static volatile unsigned long g_echo_fall_us = 0;
+static volatile bool g_echo_done = false;
+// A trigger is outstanding; ECHO edges outside this window are stray activity
+static volatile bool g_listening = false;
+static volatile uint16_t g_stray_edges = 0;
+// Non-blocking background sample in flight
+static bool g_sample_armed = false;
+static unsigned long g_sample_trig_us = 0;
+
+#if ULTRASONIC_ECHO_IRQ
+static void echo_isr() {
+  unsigned long t = micros();
+  if (!g_listening) { g_stray_edges++; return; }
+  if (digitalRead(ULTRASONIC_ECHO) == HIGH) {
+    g_echo_rise_us = t;
+  } else {
+    g_echo_fall_us = t;
+    g_echo_done = true;
+  }
+}
+#endif
+
+void ranger_init() {
+  pinMode(ULTRASONIC_TRIG, OUTPUT);
+  pinMode(ULTRASONIC_ECHO, INPUT);
+  #if ULTRASONIC_ECHO_IRQ
+  attachInterrupt(digitalPinToInterrupt(ULTRASONIC_ECHO), echo_isr, CHANGE);
+  #endif
+}
+
+const char* ranger_name() { return "hcsr04"; }
+
+static void trigger_ping() {
+  digitalWrite(ULTRASONIC_TRIG, LOW);
+  delayMicroseconds(2);
+  digitalWrite(ULTRASONIC_TRIG, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(ULTRASONIC_TRIG, LOW);
+}
+
+static void note_trigger() {
+  g_last_trig_us = micros();
+  g_listening = true;
+}
+
+// Time the last burst needs to die out: its echo path plus the reverb tail
+unsigned long ranger_gap_us(bool sweeping) {
+  #if ADAPTIVE_PING
+  (void)sweeping;
+  unsigned long listen = g_last_dur_us ? g_last_dur_us : PING_NOECHO_HOLD_US;
+  unsigned long gap = listen + g_reverb_us;
+  return gap < PING_GAP_FLOOR_US ? PING_GAP_FLOOR_US : gap;
+  #else
+  return (sweeping ? SWEEP_PING_MS : SAFETY_SAMPLE_MS) * 1000UL;
+  #endif
+}
+
+static void reverb_raise() {
+  g_reverb_us += REVERB_STEP_US;
+  if (g_reverb_us > REVERB_MAX_US) g_reverb_us = REVERB_MAX_US;
+}
+
+static void reverb_decay() {
+  g_reverb_us -= g_reverb_us >> REVERB_DECAY_SHIFT;
+  if (g_reverb_us < REVERB_MIN_US) g_reverb_us = REVERB_MIN_US;
+}
+
+static void ping_result(RangeSample* r, unsigned long rise_us, unsigned long dur_us) {
+  float cm = (float)dur_us / 58.0f;
+  r->span_us = dur_us;
+  r->mid_us = rise_us + dur_us / 2;
+  r->blind = dur_us && cm < DIST_MIN_CM;
+  r->cm = (dur_us && cm >= DIST_MIN_CM && cm <= DIST_MAX_CM) ? cm : NAN;
+}
+
+bool ranger_measure(RangeSample* out) {
+  // Too soon after the last burst (or a background ping is in flight)
+  if (g_listening || micros() - g_last_trig_us < ranger_gap_us(false)) return false;
+  trigger_ping();
+  note_trigger();
+
+  serial_rx_block_begin();
+  unsigned long duration = pulseIn(ULTRASONIC_ECHO, HIGH, ECHO_TIMEOUT_US);
+  unsigned long end = micros();
+  serial_rx_block_end();
+  g_listening = false;
+  g_last_dur_us = duration;
+  #if BENCH_MODE
+  bool dbg = gov_level() == GOV_OK; // debug lines are the first thing shed
+  if (dbg) {
+    Serial.print("DBG uls_measure: duration_us=");
+    Serial.println(duration);
+    if (duration == 0) Serial.println("DBG uls_measure: TIMEOUT (no echo received)");
+  }
+  #endif
+  ping_result(out, end - duration, duration);
+  #if BENCH_MODE
+  if (dbg && duration) {
+    Serial.print("DBG uls_measure: raw_cm=");
+    Serial.print((float)duration / 58.0f, 1);
+    Serial.print(" clamped=");
+    if (isnan(out->cm)) Serial.println("NA"); else Serial.println(out->cm, 1);
+  }
+  #endif
+  return true;
+}
+
+bool ranger_ready() {
+  return g_sample_armed && g_echo_done;
+}
+
+void ranger_stop() { g_sample_armed = false; }
+
+#if ULTRASONIC_ECHO_IRQ
+// Trigger now, collect the echo on a later pass instead of blocking in pulseIn
+static void ping_fire() {
+  g_echo_done = false;
+  trigger_ping();
+  note_trigger();
+  g_sample_trig_us = g_last_trig_us;
+  g_sample_armed = true;
+}
+
+static bool ping_collect(RangeSample* r) {
+  if (g_echo_done) {
+    noInterrupts();
+    unsigned long rise = g_echo_rise_us;
+    unsigned long fall = g_echo_fall_us;
+    interrupts();
+    ping_result(r, rise, fall - rise);
+    g_listening = false;
+  } else if (micros() - g_sample_trig_us > ECHO_TIMEOUT_US) {
+    ping_result(r, g_sample_trig_us, 0);
+  } else {
+    return false;
+  }
+  g_sample_armed = false;
+  return true;
+}
+#else
+static void ping_blocking(RangeSample* r) {
+  trigger_ping();
+  note_trigger();
+  serial_rx_block_begin();
+  unsigned long dur = pulseIn(ULTRASONIC_ECHO, HIGH, ECHO_TIMEOUT_US);
+  unsigned long end = micros();
+  serial_rx_block_end();
+  g_listening = false;
+  ping_result(r, end - dur, dur);
+}
+#endif
+
+// A reading far shorter than the last one may be the previous burst's late
+// reverb arriving in this listen window. Hold it back; the next ping decides.
+// Unless it jumps back well above the held value, it is a real obstacle (a
+// steady approach shortens every reading); otherwise it was a ghost and the
+// tail estimate grows. Either way the next ping itself is accepted.
+static bool ghost_filter(float cm, bool sweeping) {
+  // The horn turns between pings, so a drop is an edge, not a ghost
+  if (sweeping) { g_suspect_cm = NAN; return true; }
+  if (!isnan(g_suspect_cm)) {
+    float held = g_suspect_cm;
+    g_suspect_cm = NAN;
+    if (isnan(cm) || cm > held * (1.0f + GHOST_CONFIRM_PCT / 100.0f)) {
+      g_ghosts++;
+      reverb_raise();
+    }
+    return true;
+  }
+  bool suspect = !isnan(cm) && !isnan(g_prev_cm) && cm < GHOST_RATIO * g_prev_cm;
+  // Inside any consumer's reach (stop threshold, protective/warning fields,
+  // follow stand-off) nothing is held: a real obstacle there must not wait a
+  // ping. The stop and field checks debounce a ghost; follow eases off a tick
+  uint16_t reach = max(getSafetyThresholdCM(), max(fields_reach_cm(), follow_dist_cm()));
+  if (suspect && !(reach && cm < (float)reach)) {
+    g_suspect_cm = cm;
+    return false;
+  }
+  reverb_decay();
+  return true;
+}
+
+// Accepted samples only: a held-back ghost suspect produces nothing
+static bool finish_sample(const RangeSample& r, bool sweeping) {
+  g_last_dur_us = r.span_us;
+  #if ADAPTIVE_PING
+  if (!ghost_filter(r.cm, sweeping)) return false;
+  #else
+  (void)sweeping;
+  #endif
+  g_prev_cm = r.cm;
+  return true;
+}
+
+bool ranger_poll(RangeSample* out, bool sweeping) {
+  #if ULTRASONIC_ECHO_IRQ
+  if (g_sample_armed) return ping_collect(out) && finish_sample(*out, sweeping);
+  unsigned long since = micros() - g_last_trig_us;
+  // After a timeout the sensor still holds ECHO high until its own hold expires
+  if (g_listening && (g_echo_done || since > PING_NOECHO_HOLD_US)) g_listening = false;
+  // Edges with nothing in flight: the room (or sensor) is still ringing
+  if (g_stray_edges) {
+    g_stray_edges = 0;
+    reverb_raise();
+  }
+  if (g_listening || since < ranger_gap_us(sweeping)) return false;
+  ping_fire();
+  return false;
+  #else
+  if (micros() - g_last_trig_us < ranger_gap_us(sweeping)) return false;
+  ping_blocking(out);
+  return finish_sample(*out, sweeping);
+  #endif
+}
+
+void ranger_print_stats() {
+  Serial.print(" reverb_us="); Serial.print(g_reverb_us);
+  Serial.print(" ghosts="); Serial.print(g_ghosts);
+}
+
+#endif
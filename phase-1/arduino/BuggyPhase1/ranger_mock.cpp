@@ -0,0 +1,62 @@
+// Mock back-end: a sample every RANGER_MOCK_PERIOD_US from a settable source,
+// so the consumers can be exercised on the host or on a board with no sensor
+#include <Arduino.h>
+#include "config.h"
+
+#if RANGER_BACKEND == RANGER_MOCK
+#include "ranger.h"
+
+static RangerMockSource g_source = NULL;
+static unsigned long g_next_us = 0;
+static bool g_running = false;
+static uint32_t g_samples = 0;
+
+void ranger_init() {}
+
+const char* ranger_name() { return "mock"; }
+
+void ranger_mock_set_source(RangerMockSource fn) { g_source = fn; }
+
+unsigned long ranger_gap_us(bool sweeping) {
+  (void)sweeping;
+  return RANGER_MOCK_PERIOD_US;
+}
+
+void ranger_stop() { g_running = false; }
+
+bool ranger_ready() { return g_running && (long)(micros() - g_next_us) >= 0; }
+
+static void make(RangeSample* out, unsigned long now) {
+  float cm = g_source ? g_source(now) : RANGER_MOCK_CM;
+  out->mid_us = now;
+  out->span_us = 0; // instantaneous
+  out->blind = !isnan(cm) && cm < DIST_MIN_CM;
+  out->cm = (!isnan(cm) && cm >= DIST_MIN_CM && cm <= DIST_MAX_CM) ? cm : NAN;
+  g_samples++;
+}
+
+bool ranger_poll(RangeSample* out, bool sweeping) {
+  (void)sweeping;
+  unsigned long now = micros();
+  if (!g_running) {
+    g_running = true;
+    g_next_us = now + RANGER_MOCK_PERIOD_US;
+    return false;
+  }
+  if ((long)(now - g_next_us) < 0) return false;
+  g_next_us += RANGER_MOCK_PERIOD_US;
+  if ((long)(now - g_next_us) >= 0) g_next_us = now + RANGER_MOCK_PERIOD_US; // fell behind: no burst
+  make(out, now);
+  return true;
+}
+
+bool ranger_measure(RangeSample* out) {
+  make(out, micros());
+  return true;
+}
+
+void ranger_print_stats() {
+  Serial.print(" samples="); Serial.print(g_samples);
+}
+
+#endif
@@ -0,0 +1,127 @@
+// VL53L0X back-end: the library (Pololu "VL53L0X") does the ST init sequence
+// and register access; ranging runs back-to-back in continuous mode and the
+// sensor's GPIO1 data-ready line interrupts, so samples are read only when
+// they exist and nothing ever polls the bus while the loop is busy.
+#include <Arduino.h>
+#include "config.h"
+
+#if RANGER_BACKEND == RANGER_VL53L0X
+#include <Wire.h>
+#include <VL53L0X.h>
+#include "ranger.h"
+#include "pins.h"
+#include "serial_rx.h"
+
+#define TOF_OUT_OF_RANGE_MM 8190 // the sensor reports 8190/8191 with no target
+
+static VL53L0X g_tof;
+static bool g_ok = false;       // init succeeded
+static bool g_running = false;  // continuous mode started
+static volatile bool g_ready = false;
+static volatile unsigned long g_ready_us = 0;
+static unsigned long g_last_us = 0;   // data-ready time of the last sample taken
+static uint32_t g_errors = 0;         // bus timeouts while reading
+
+static void tof_isr() {
+  g_ready_us = micros();
+  g_ready = true;
+}
+
+void ranger_init() {
+  Wire.begin();
+  Wire.setClock(TOF_I2C_HZ);
+  pinMode(TOF_GPIO1, INPUT_PULLUP);
+  g_tof.setTimeout(TOF_IO_TIMEOUT_MS);
+  // init() also routes "new sample ready" to GPIO1, active-LOW
+  g_ok = g_tof.init() && g_tof.setMeasurementTimingBudget(TOF_BUDGET_US);
+  if (!g_ok) { Serial.println("ERR,TOF_INIT"); return; }
+  attachInterrupt(digitalPinToInterrupt(TOF_GPIO1), tof_isr, FALLING);
+}
+
+const char* ranger_name() { return "vl53l0x"; }
+
+unsigned long ranger_gap_us(bool sweeping) {
+  (void)sweeping;
+  return TOF_BUDGET_US;
+}
+
+// GPIO1 stays LOW until the interrupt is cleared; a result left unread would
+// hold it there and no FALLING edge would ever come again
+static void clear_ready() {
+  g_tof.writeReg(VL53L0X::SYSTEM_INTERRUPT_CLEAR, 0x01);
+  g_ready = false;
+}
+
+static void start() {
+  if (g_running || !g_ok) return;
+  clear_ready();
+  g_tof.startContinuous(0);
+  g_running = true;
+}
+
+void ranger_stop() {
+  if (!g_running) return;
+  g_tof.stopContinuous();
+  clear_ready();
+  g_running = false;
+}
+
+// The level as well as the edge, so a missed edge cannot stall sampling.
+// Also called with interrupts masked (idle check); racing the ISR only moves
+// g_ready_us by a few us.
+static bool data_ready() {
+  if (g_ready) return true;
+  if (!g_running || digitalRead(TOF_GPIO1) != LOW) return false;
+  g_ready_us = micros();
+  g_ready = true;
+  return true;
+}
+
+bool ranger_ready() { return data_ready(); }
+
+// Data is ready, so the library's status poll succeeds on its first read
+static bool take(RangeSample* out) {
+  noInterrupts();
+  unsigned long at = g_ready_us;
+  g_ready = false;
+  interrupts();
+  uint16_t mm = g_tof.readRangeContinuousMillimeters();
+  if (g_tof.timeoutOccurred()) {
+    g_errors++;
+    return false;
+  }
+  g_last_us = at;
+  float cm = mm / 10.0f;
+  out->mid_us = at - TOF_BUDGET_US / 2;
+  out->span_us = TOF_BUDGET_US;
+  out->blind = mm < TOF_OUT_OF_RANGE_MM && cm < DIST_MIN_CM;
+  out->cm = (mm < TOF_OUT_OF_RANGE_MM && cm >= DIST_MIN_CM && cm <= DIST_MAX_CM) ? cm : NAN;
+  return true;
+}
+
+bool ranger_poll(RangeSample* out, bool sweeping) {
+  (void)sweeping;
+  start();
+  return data_ready() && take(out);
+}
+
+bool ranger_measure(RangeSample* out) {
+  if (!g_ok) return false;
+  if (!g_running) start();
+  else if (!data_ready() && micros() - g_last_us < TOF_BUDGET_US) return false;
+  // Wait out the sample in progress, as pulseIn does for an echo
+  unsigned long t0 = micros();
+  serial_rx_block_begin();
+  bool ready;
+  while (!(ready = data_ready()) && micros() - t0 <= 2 * TOF_BUDGET_US) {}
+  serial_rx_block_end();
+  if (!ready) { g_errors++; return false; }
+  return take(out);
+}
+
+void ranger_print_stats() {
+  Serial.print(" budget_us="); Serial.print(TOF_BUDGET_US);
+  Serial.print(" errors="); Serial.print(g_errors);
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include "scan.h"
+#include "config.h"
+#include "servo_scan.h"
+#include "gaps.h"
+#include "scan_codec.h"
+
+// Double-buffered: samples land in the open frame while the last completed
+// one stays readable for consumers
+static ScanFrame g_frames[2];
+static uint8_t g_open = 0;
+static bool g_frame_open = false;
+static bool g_have_last = false;
+static uint16_t g_open_pass = 0;
+static uint16_t g_seq = 0;
+static bool g_binary = (SCAN_FORMAT_DEFAULT != 0);
+
+void scan_init() {
+  g_frame_open = false;
+  g_have_last = false;
+}
+
+static void begin_frame() {
+  ScanFrame& f = g_frames[g_open];
+  f.t0_ms = millis();
+  f.seq = g_seq++;
+  f.dir = (int8_t)servo_sweep_dir();
+  f.n = 0;
+  g_open_pass = servo_sweep_pass();
+  g_frame_open = true;
+}
+
+static void end_frame() {
+  ScanFrame& f = g_frames[g_open];
+  g_frame_open = false;
+  if (g_binary) {
+    scan_emit_binary(&f);
+  } else {
+    // SCN end seq=<n> n=<samples> dir=<+1|-1> dur_ms=<ms>
+    Serial.print("SCN end seq="); Serial.print(f.seq);
+    Serial.print(" n="); Serial.print(f.n);
+    Serial.print(" dir="); Serial.print(f.dir);
+    Serial.print(" dur_ms="); Serial.println(millis() - f.t0_ms);
+  }
+  g_open ^= 1;
+  g_have_last = true;
+  gaps_process(&f);
+}
+
+void scan_tick() {
+  if (!g_frame_open) return;
+  if (!servo_is_sweeping() || servo_sweep_pass() != g_open_pass) end_frame();
+}
+
+void scan_add_ping(float cm, unsigned long mid_us, unsigned long dur_us) {
+  if (!g_frame_open) begin_frame();
+  ScanFrame& f = g_frames[g_open];
+
+  float vel = 0.0f;
+  float deg = servo_position_at_us(mid_us - SERVO_LAG_US, &vel);
+  // The horn turns while the burst is in flight (half the echo time either
+  // side of the midpoint) and the lag itself is only known to SERVO_LAG_UNC_US
+  float unc = fabsf(vel) * ((float)dur_us * 0.5e-6f + (float)SERVO_LAG_UNC_US * 1e-6f);
+  unc += 180.0f / (SERVO_MAX_US - SERVO_MIN_US); // one-microsecond pulse step
+
+  ScanSample smp;
+  smp.angle_cdeg = (int16_t)(deg * 100.0f + 0.5f);
+  smp.unc_cdeg = (uint16_t)(unc * 100.0f + 0.5f);
+  smp.range_mm = isnan(cm) ? 0 : (uint16_t)(cm * 10.0f + 0.5f);
+  smp.dt_ms = (uint16_t)(millis() - f.t0_ms);
+  if (f.n < SCAN_MAX_SAMPLES) f.s[f.n++] = smp;
+  if (g_binary) return;
+
+  // SCN a=<cdeg> u=<cdeg> cm=<cm|-1> t_ms=<millis>
+  Serial.print("SCN a="); Serial.print(smp.angle_cdeg);
+  Serial.print(" u="); Serial.print(smp.unc_cdeg);
+  Serial.print(" cm="); if (isnan(cm)) Serial.print(-1); else Serial.print(cm, 1);
+  Serial.print(" t_ms="); Serial.println(f.t0_ms + smp.dt_ms);
+}
+
+const ScanFrame* scan_last_frame() {
+  return g_have_last ? &g_frames[g_open ^ 1] : NULL;
+}
+
+void scan_set_binary(bool on) { g_binary = on; }
+bool scan_get_binary() { return g_binary; }
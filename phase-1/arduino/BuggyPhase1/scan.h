@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// One sweep pass worth of ranged samples
+struct ScanSample {
+  int16_t angle_cdeg;  // angle at echo midpoint (servo lag compensated)
+  uint16_t unc_cdeg;   // +/- angle uncertainty
+  uint16_t range_mm;   // 0 = no/invalid echo
+  uint16_t dt_ms;      // since frame start
+};
+
+struct ScanFrame {
+  uint32_t t0_ms;
+  uint16_t seq;
+  int8_t dir;          // +1 = sweeping toward SWEEP_LEFT_DEG
+  uint8_t n;
+  ScanSample s[SCAN_MAX_SAMPLES];
+};
+
+void scan_init();
+void scan_tick();     // closes the open frame at a sweep turnaround/stop
+void scan_add_ping(float cm, unsigned long mid_us, unsigned long dur_us);
+const ScanFrame* scan_last_frame(); // most recent completed frame, or NULL
+
+// Output format: text (SCN per sample + SCN end) or binary (one SCB per pass)
+void scan_set_binary(bool on);
+bool scan_get_binary();
@@ -0,0 +1,100 @@
+#include <Arduino.h>
+#include "scan_codec.h"
+#include "config.h"
+
+static uint8_t g_buf[SCB_MAX_BYTES];
+
+static uint16_t crc16_ccitt(const uint8_t* p, size_t n) {
+  uint16_t crc = 0xFFFF;
+  while (n--) {
+    crc ^= (uint16_t)(*p++) << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+struct Writer {
+  uint8_t* p;
+  size_t len;
+  size_t cap;
+  bool ok;
+  void u8(uint8_t v) { if (len < cap) p[len++] = v; else ok = false; }
+  void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); }
+  void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+  void varint(uint32_t v) {
+    while (v >= 0x80) { u8((uint8_t)(v | 0x80)); v >>= 7; }
+    u8((uint8_t)v);
+  }
+  void zigzag(int32_t v) { varint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+};
+
+size_t scan_encode(const ScanFrame* f, uint8_t* out, size_t cap) {
+  if (f == NULL || f->n == 0) return 0;
+  uint8_t n = f->n;
+  const ScanSample* s = f->s;
+
+  // Fixed steps when every sample sits within tolerance of a straight line
+  int16_t a_step = 0;
+  uint16_t t_step = 0;
+  uint8_t flags = (f->dir > 0) ? SCB_FLAG_DIR_LEFT : 0;
+  if (n > 1) {
+    a_step = (int16_t)((s[n - 1].angle_cdeg - s[0].angle_cdeg) / (n - 1));
+    t_step = (uint16_t)((s[n - 1].dt_ms - s[0].dt_ms) / (n - 1));
+  }
+  bool fixed_a = true, fixed_t = true;
+  uint16_t unc_max = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    int32_t ea = (int32_t)s[i].angle_cdeg - (s[0].angle_cdeg + (int32_t)a_step * i);
+    int32_t et = (int32_t)s[i].dt_ms - (s[0].dt_ms + (int32_t)t_step * i);
+    if (ea > SCB_ANGLE_FIT_CDEG || ea < -SCB_ANGLE_FIT_CDEG) fixed_a = false;
+    if (et > 1 || et < -1) fixed_t = false;
+    if (s[i].unc_cdeg > unc_max) unc_max = s[i].unc_cdeg;
+  }
+  if (fixed_a) flags |= SCB_FLAG_FIXED_ANGLE; else a_step = 0;
+  if (fixed_t) flags |= SCB_FLAG_FIXED_TIME; else t_step = 0;
+
+  Writer w = { out, 0, cap, true };
+  w.u8(SCB_VERSION);
+  w.u8(flags);
+  w.u16(f->seq);
+  w.u32(f->t0_ms + s[0].dt_ms);
+  w.u16((uint16_t)s[0].angle_cdeg);
+  w.u16((uint16_t)a_step);
+  w.u16(t_step);
+  w.u16(unc_max);
+  w.u8(n);
+  for (uint8_t i = 0; i < n; i += 8) {
+    uint8_t bits = 0;
+    for (uint8_t k = 0; k < 8 && i + k < n; k++) if (s[i + k].range_mm) bits |= (uint8_t)(1u << k);
+    w.u8(bits);
+  }
+  if (!fixed_a) for (uint8_t i = 1; i < n; i++) w.zigzag((int32_t)s[i].angle_cdeg - s[i - 1].angle_cdeg);
+  if (!fixed_t) for (uint8_t i = 1; i < n; i++) w.varint((uint32_t)(s[i].dt_ms - s[i - 1].dt_ms));
+  int32_t prev = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].range_mm) continue;
+    w.zigzag((int32_t)s[i].range_mm - prev);
+    prev = s[i].range_mm;
+  }
+  w.u16(crc16_ccitt(out, w.len));
+  return w.ok ? w.len : 0;
+}
+
+void scan_emit_binary(const ScanFrame* f) {
+  static const char B64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t len = scan_encode(f, g_buf, sizeof(g_buf));
+  if (len == 0) return;
+  Serial.print("SCB ");
+  char quad[4];
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)g_buf[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)g_buf[i + 1] << 8;
+    if (i + 2 < len) v |= g_buf[i + 2];
+    quad[0] = B64[(v >> 18) & 63];
+    quad[1] = B64[(v >> 12) & 63];
+    quad[2] = (i + 1 < len) ? B64[(v >> 6) & 63] : '=';
+    quad[3] = (i + 2 < len) ? B64[v & 63] : '=';
+    Serial.write((const uint8_t*)quad, 4);
+  }
+  Serial.println();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#include "scan.h"
+
+// Compact scan frame (little-endian), sent as "SCB <base64>":
+//   u8  version (1)
+//   u8  flags: bit0 fixed angle step, bit1 fixed time step, bit2 dir=+1
+//   u16 seq, u32 t0_ms (time of sample 0)
+//   i16 a0_cdeg, i16 a_step_cdeg, u16 t_step_ms, u16 unc_max_cdeg
+//     (largest per-sample unc_cdeg: the per-sample values are not sent)
+//   u8  n, then ceil(n/8) validity bitmap (LSB = sample 0)
+//   [!fixed angle] n-1 zig-zag varint angle deltas (cdeg)
+//   [!fixed time]  n-1 varint time deltas (ms)
+//   zig-zag varint range deltas (mm) for valid samples only, from 0
+//   u16 CRC-16/CCITT-FALSE of everything above
+#define SCB_VERSION 1
+#define SCB_FLAG_FIXED_ANGLE 0x01
+#define SCB_FLAG_FIXED_TIME 0x02
+#define SCB_FLAG_DIR_LEFT 0x04
+#define SCB_MAX_BYTES (19 + (SCAN_MAX_SAMPLES + 7) / 8 + 3 * 3 * SCAN_MAX_SAMPLES)
+
+size_t scan_encode(const ScanFrame* f, uint8_t* out, size_t cap); // 0 if it doesn't fit
+void scan_emit_binary(const ScanFrame* f);
@@ -1,28 +1,58 @@
 #include <Arduino.h>
+#include <string.h>
 #include "serial_proto.h"
 #include "motion.h"
 #include "servo_scan.h"
 #include "ultrasonic.h"
+#include "battery.h"
 #include "servo_scan.h"
 #include "config.h"
 #include "watchdog.h"
 #include "status.h"
+#include "idle.h"
+#include "memguard.h"
+#include "scan.h"
+#include "serial_rx.h"
+#include "follow.h"
+#include "teach.h"
+#include "fields.h"
+#include "gov.h"
 
-static String g_line;
+static bool starts_with(const char* s, const char* prefix) {
+  return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+// Per-wheel turn modes: <NAME>[<n>], optional speed as for F/B/L/R
+struct WheelModeCmd { const char* name; MotionMode mode; };
+static const WheelModeCmd WHEEL_MODES[] = {
+  { "PIVOTL", MODE_PIVOT_LEFT }, { "PIVOTR", MODE_PIVOT_RIGHT },
+  { "FSPINL", MODE_FRONT_SPIN_LEFT }, { "FSPINR", MODE_FRONT_SPIN_RIGHT },
+  { "RSPINL", MODE_REAR_SPIN_LEFT }, { "RSPINR", MODE_REAR_SPIN_RIGHT },
+  { "XSPINL", MODE_SCRUB_SPIN_LEFT }, { "XSPINR", MODE_SCRUB_SPIN_RIGHT },
+};
+
+static void apply_speed(const char* arg) {
+  int spd = (*arg == '\0') ? DEFAULT_BENCH_PWM : constrain(atoi(arg), 0, 255);
+  motion_pwm_speed(spd);
+}
 
-static void handle_command(const String& line) {
+static void print_credit();
+
+static void handle_command(const char* line) {
   // Compact parser with legacy aliases. line is trimmed of CR/LF.
-  if (line.length() == 0) return;
+  if (line[0] == '\0') return;
 
   // Legacy aliases to compact forms
-  if (line.startsWith("SERVO,")) {
-    int comma = line.indexOf(',');
-    String deg = line.substring(comma + 1);
-    handle_command(String("P") + deg);
+  if (starts_with(line, "SERVO,")) {
+    char alias[CMD_LINE_MAX + 1];
+    alias[0] = 'P';
+    strncpy(alias + 1, line + 6, CMD_LINE_MAX - 1);
+    alias[CMD_LINE_MAX] = '\0';
+    handle_command(alias);
     return;
   }
   // PING must reply with a single DIST line for Jetson runtime
-  if (line == "PING") {
+  if (strcmp(line, "PING") == 0) {
     if (servo_is_settled()) {
       float cm = ultrasonic_measure_cm();
       if (isnan(cm)) Serial.println("DIST,NA");
@@ -32,48 +62,142 @@ static void handle_command(const String& line) {
     }
     return;
   }
-  if (line == "STOP") { handle_command("S"); return; }
-  if (line == "SPINL") { handle_command("L"); return; }
-  if (line == "SPINR") { handle_command("R"); return; }
-  if (line == "F,FAST") { handle_command("F230"); return; }
-  if (line == "F,SLOW") { handle_command("F150"); return; }
+  if (strcmp(line, "STOP") == 0) { handle_command("S"); return; }
+  if (starts_with(line, "SPINL") || starts_with(line, "SPINR")) {
+    // SPINL[<n>] -> L[<n>], speed suffix as for the per-wheel modes
+    char alias[CMD_LINE_MAX + 1];
+    alias[0] = line[4];
+    strncpy(alias + 1, line + 5, CMD_LINE_MAX - 1);
+    alias[CMD_LINE_MAX] = '\0';
+    handle_command(alias);
+    return;
+  }
+  if (strcmp(line, "F,FAST") == 0) { handle_command("F230"); return; }
+  if (strcmp(line, "F,SLOW") == 0) { handle_command("F150"); return; }
+  if (strcmp(line, "B,SLOW") == 0) { handle_command("B150"); return; }
+  // Controller arcs: inner track pulsed under the FAST tier, so no override
+  if (strcmp(line, "L,SLOW") == 0) { motion_clear_pwm_speed(); motion_set_mode(MODE_ARC_LEFT); return; }
+  if (strcmp(line, "R,SLOW") == 0) { motion_clear_pwm_speed(); motion_set_mode(MODE_ARC_RIGHT); return; }
 
   // Control of verbosity and quick status
-  if (line == "STAT?") { status_emit_once(); return; }
-  if (line == "VERBOSE,ON") { status_set_verbose(true); return; }
-  if (line == "VERBOSE,OFF") { status_set_verbose(false); return; }
-  if (line == "H") { Serial.println("CMD: F/B/L/R<n>, S, P<deg>, T<n>, Q, H"); return; }
+  if (strcmp(line, "STAT?") == 0) { status_emit_once(); return; }
+  if (strcmp(line, "VERBOSE,ON") == 0) { status_set_verbose(true); return; }
+  if (strcmp(line, "VERBOSE,OFF") == 0) { status_set_verbose(false); return; }
+  if (strcmp(line, "IDLE?") == 0) { printIdle(); return; }
+  if (strcmp(line, "GOV?") == 0) { printGov(); return; }
+  if (strcmp(line, "IDLE,ON") == 0) { idle_set_enabled(true); return; }
+  if (strcmp(line, "IDLE,OFF") == 0) { idle_set_enabled(false); return; }
+  if (strcmp(line, "MEM?") == 0) { printMem(); return; }
+  if (strcmp(line, "RNG?") == 0) { printRng(); return; }
+  if (strcmp(line, "SAFE?") == 0) { printSafe(); return; }
+  if (strcmp(line, "FLD?") == 0) { printFields(); return; }
+  if (starts_with(line, "FLD,")) { if (!fields_command(line + 4)) Serial.println("ERR,FLD"); return; }
+  if (strcmp(line, "BAT?") == 0) { printBat(status_capture()); return; }
+  if (strcmp(line, "CRD?") == 0) { print_credit(); return; }
+  if (starts_with(line, "SWEEP,ON")) {
+    // SWEEP,ON[,<deg_per_s>]
+    if (line[8] == ',') servo_set_sweep_velocity(atof(line + 9));
+    servo_startSweep();
+    return;
+  }
+  if (strcmp(line, "SWEEP,OFF") == 0) { servo_stopSweep(); return; }
+  if (starts_with(line, "VT,")) {
+    // VT,<bearing_deg>,<range_cm|NA>,<age_ms>; only HB feeds the watchdog
+    const char* rng = strchr(line + 3, ',');
+    const char* age = rng ? strchr(rng + 1, ',') : nullptr;
+    if (!age) return;
+    float cm = (rng[1] == 'N') ? NAN : atof(rng + 1);
+    follow_update(atof(line + 3), cm, (uint16_t)constrain(atol(age + 1), 0L, 60000L));
+    return;
+  }
+  if (starts_with(line, "FOLLOW,ON")) {
+    // FOLLOW,ON[,<dist_cm>]
+    follow_start(line[9] == ',' ? (uint16_t)max(0, atoi(line + 10)) : 0);
+    return;
+  }
+  if (strcmp(line, "FOLLOW,OFF") == 0) { follow_stop(); return; }
+  if (strcmp(line, "FOLLOW?") == 0) { printFollow(); return; }
+  if (strcmp(line, "REC,ON") == 0) { if (!teach_rec_start()) Serial.println("ERR,REC_BUSY"); return; }
+  if (strcmp(line, "REC,OFF") == 0) { teach_rec_stop(); return; }
+  if (strcmp(line, "REC?") == 0) { printRec(); return; }
+  if (strcmp(line, "PLAY") == 0) {
+    if (teach_playing()) return;
+    // An unattended replay needs something that can stop it short of a wall
+    if (getSafetyThresholdCM() == 0 && !fields_enabled()) { Serial.println("ERR,SAFETY_OFF"); return; }
+    if (!teach_play_start()) Serial.println(teach_recording() ? "ERR,REC_BUSY" : "ERR,REC_EMPTY");
+    return;
+  }
+  if (strcmp(line, "SCAN,TXT") == 0) { scan_set_binary(false); return; }
+  if (strcmp(line, "SCAN,BIN") == 0) { scan_set_binary(true); return; }
+  if (strcmp(line, "SRV?") == 0) { printServo(status_capture()); return; }
+  if (starts_with(line, "SRV,")) {
+    // SRV,<max_vel_dps>[,<max_acc_dps2>]
+    const char* acc = strchr(line + 4, ',');
+    servo_set_limits(atof(line + 4), acc ? atof(acc + 1) : 0.0f);
+    return;
+  }
+  if (strcmp(line, "H") == 0) { Serial.println("CMD: F/B/L/R<n>, S, P<deg>, T<n>[,<r>,<ms>], Q, H"); return; }
+  for (uint8_t i = 0; i < sizeof(WHEEL_MODES) / sizeof(WHEEL_MODES[0]); i++) {
+    if (starts_with(line, WHEEL_MODES[i].name)) {
+      apply_speed(line + strlen(WHEEL_MODES[i].name));
+      motion_set_mode(WHEEL_MODES[i].mode);
+      return;
+    }
+  }
+  // Raw wheels: W<FL><RL><RR><FR>[<n>] with each of + - 0, e.g. W+0-0
+  if (line[0] == 'W' && strlen(line) >= 5) {
+    int8_t dir[4];
+    for (uint8_t m = 0; m < 4; m++) {
+      char d = line[1 + m];
+      if (d != '+' && d != '-' && d != '0') return;
+      dir[m] = (d == '+') ? 1 : (d == '-' ? -1 : 0);
+    }
+    motion_set_wheels(dir);
+    apply_speed(line + 5);
+    motion_set_mode(MODE_WHEELS);
+    return;
+  }
   // Heartbeat - just update watchdog, no reply needed
-  if (line == "HB") { watchdog_note_hb(); return; }
+  if (strcmp(line, "HB") == 0) { watchdog_note_hb(); return; }
 
-  char c = line.charAt(0);
-  String arg = line.substring(1);
-  arg.trim();
+  char c = line[0];
+  const char* arg = line + 1;
+  while (*arg == ' ' || *arg == '\t') arg++;
 
-  auto parseIntSafe = [&](const String& s, int def)->int{
-    if (s.length() == 0) return def;
-    return s.toInt();
+  auto parseIntSafe = [&](const char* s, int def)->int{
+    if (*s == '\0') return def;
+    return atoi(s);
   };
 
   switch (c) {
-    case 'H': Serial.println("CMD: F/B/L/R<n>, S, P<deg>, T<n>, Q, H"); return;
+    case 'H': Serial.println("CMD: F/B/L/R<n>, S, P<deg>, T<n>[,<r>,<ms>], Q, H"); return;
     case 'Q':
-      // One-shot STAT and ULS
-      printStat();
-      printULS();
+      // One-shot STAT and ULS, both from the same capture
+      { const StatusSnap& s = status_capture(); printStat(s); printULS(s); }
       return;
     case 'S':
+      teach_play_abort("command");
+      safety_hold_cancel();
       motion_set_mode(MODE_STOP);
       motion_pwm_speed(0);
       return;
     case 'P': {
-      int deg = constrain(parseIntSafe(arg, 90), 0, 180);
+      // Accepts fractional degrees (P92.5) for fine positioning
+      float deg = (*arg == '\0') ? 90.0f : atof(arg);
+      deg = constrain(deg, 0.0f, 180.0f);
       servo_stopSweep();
-      servo_set_target_deg(deg);
+      servo_set_target_cdeg((int)(deg * 100.0f + 0.5f));
       return; }
     case 'T': {
+      // T<stop>[,<resume>[,<clear_ms>]]; a bare T<n> leaves the resume pair as set
       int cm = max(0, parseIntSafe(arg, 0));
       setSafetyThresholdCM((uint16_t)cm);
+      const char* res = strchr(arg, ',');
+      if (res) {
+        const char* clr = strchr(res + 1, ',');
+        uint16_t ms = clr ? (uint16_t)constrain(atol(clr + 1), 0L, 60000L) : getSafetyClearMs();
+        setSafetyResume((uint16_t)max(0, atoi(res + 1)), ms);
+      }
       return; }
     case 'F': {
       int spd = constrain(parseIntSafe(arg, DEFAULT_BENCH_PWM), 0, 255);
@@ -99,26 +223,48 @@ static void handle_command(const String& line) {
 }
 
 void serial_proto_init() {
-  g_line.reserve(64);
+  serial_rx_init();
+}
+
+// CR l=<lines> b=<bytes> win=<bytes> ovf=<bytes dropped> trunc=<lines>
+// l/b are cumulative consumption counters; the host keeps sent - b <= win.
+static uint32_t g_cr_bytes = 0;
+static unsigned long g_cr_ms = 0;
+
+static void print_credit() {
+  g_cr_bytes = serial_rx_consumed_bytes();
+  g_cr_ms = millis();
+  Serial.print("CR l="); Serial.print(serial_rx_consumed_lines());
+  Serial.print(" b="); Serial.print(g_cr_bytes);
+  Serial.print(" win="); Serial.print(serial_rx_window());
+  Serial.print(" ovf="); Serial.print(serial_rx_dropped());
+  Serial.print(" trunc="); Serial.println(serial_rx_truncated());
+}
+
+static void credit_tick() {
+  #if CREDIT_REPORT
+  uint32_t moved = serial_rx_consumed_bytes() - g_cr_bytes;
+  if (moved == 0) return;
+  // Batch: one report per CREDIT_MIN_MS unless half the window has been freed
+  if (millis() - g_cr_ms < CREDIT_MIN_MS && moved < serial_rx_window() / 2u) return;
+  print_credit();
+  #endif
 }
 
 void serial_proto_tick() {
-  while (Serial.available() > 0) {
-    char c = (char)Serial.read();
-    if (c == '\n' || c == '\r') {
-      if (g_line.length() > 0) {
-        // Trim any stray CR that may have been appended (e.g., \r\n terminals)
-        while (g_line.length() > 0) {
-          char last = g_line.charAt(g_line.length() - 1);
-          if (last == '\r' || last == '\n') g_line.remove(g_line.length() - 1); else break;
-        }
-        // Trim surrounding whitespace
-        g_line.trim();
-        handle_command(g_line);
-        g_line = "";
-      }
-    } else {
-      if (g_line.length() < 63) g_line += c;
-    }
+  serial_rx_poll();
+  char line[CMD_LINE_MAX + 1];
+  RxLine got;
+  while ((got = serial_rx_line(line, sizeof(line))) != RX_NONE) {
+    // Never execute a partial command
+    if (got == RX_TRUNCATED) { Serial.println("ERR,TRUNC"); continue; }
+    if (got == RX_DAMAGED) { Serial.println("ERR,OVF"); continue; }
+    // Trim surrounding whitespace
+    char* start = line;
+    while (*start == ' ' || *start == '\t') start++;
+    size_t len = strlen(start);
+    while (len > 0 && (start[len - 1] == ' ' || start[len - 1] == '\t')) start[--len] = '\0';
+    handle_command(start);
   }
+  credit_tick();
 }
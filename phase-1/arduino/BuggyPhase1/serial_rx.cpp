@@ -0,0 +1,178 @@
+#include <Arduino.h>
+#include "serial_rx.h"
+#include "config.h"
+#include "motion.h"
+
+#if SERIAL_RX_ISR && defined(ARDUINO_ARCH_RENESAS)
+#include <FspTimer.h>
+#define RX_FROM_ISR 1
+static FspTimer g_rx_timer;
+static bool g_rx_isr = false; // timer running
+static bool g_rx_paused = false; // stopped for WFI by serial_rx_sleep()
+// The core's Serial is not safe against an ISR while the loop prints, so the
+// timer only drains it between serial_rx_block_begin() and _end(), where the
+// loop has promised not to touch Serial; everywhere else loop() pumps.
+static volatile bool g_isr_owns = false;
+#else
+#define RX_FROM_ISR 0
+#endif
+
+#define RX_MASK (RX_RING_SIZE - 1)
+#define RX_EOL_DAMAGED '\x15' // terminates a line that lost bytes to a full ring
+
+static volatile uint8_t g_ring[RX_RING_SIZE];
+// Producer-owned
+static volatile uint16_t g_head = 0;
+static volatile uint16_t g_lines_in = 0;
+static volatile uint32_t g_dropped = 0;
+static volatile uint32_t g_urgent = 0;
+static volatile uint32_t g_skipped = 0;
+static uint8_t g_prod_len = 0;
+static bool g_prod_damaged = false;
+static char g_prod_prefix[4];
+// Consumer-owned
+static volatile uint16_t g_tail = 0;
+static volatile uint16_t g_lines_out = 0;
+static uint32_t g_truncated = 0;
+static uint32_t g_bytes_out = 0;
+
+static bool is_urgent_stop() {
+  if (g_prod_len == 1) return g_prod_prefix[0] == 'S';
+  if (g_prod_len == 4) return memcmp(g_prod_prefix, "STOP", 4) == 0;
+  return false;
+}
+
+static void pump() {
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    uint16_t used = (uint16_t)(g_head - g_tail);
+    if (c == '\n' || c == '\r') {
+      if (g_prod_len == 0) { g_skipped++; continue; } // blank line / second half of CRLF
+      // The prefix counts dropped bytes too, so a stop fires even on a line
+      // the full ring damaged (overload is when it matters most)
+      if (is_urgent_stop()) { motion_emergency_stop(); g_urgent++; }
+      if (used >= RX_RING_SIZE) {
+        // A slot is kept for EOL, so this whole line was dropped: nothing to end
+        g_dropped++;
+        g_prod_len = 0;
+        g_prod_damaged = false;
+        continue;
+      }
+      g_ring[g_head & RX_MASK] = g_prod_damaged ? RX_EOL_DAMAGED : '\n';
+      g_head++;
+      g_lines_in++;
+      g_prod_len = 0;
+      g_prod_damaged = false;
+    } else {
+      if (g_prod_len < sizeof(g_prod_prefix)) g_prod_prefix[g_prod_len] = c;
+      if (g_prod_len < 255) g_prod_len++;
+      // Keep the last slot free so a truncated line can still be terminated
+      if (used >= RX_RING_SIZE - 1) { g_dropped++; g_prod_damaged = true; continue; }
+      g_ring[g_head & RX_MASK] = (uint8_t)c;
+      g_head++;
+    }
+  }
+}
+
+#if RX_FROM_ISR
+static void rx_timer_cb(timer_callback_args_t* args) {
+  (void)args;
+  if (g_isr_owns) pump();
+  motion_gate_isr(); // after pump: an urgent stop in this slot wins
+}
+#endif
+
+void serial_rx_init() {
+  #if RX_FROM_ISR
+  uint8_t type = GPT_TIMER;
+  int8_t ch = FspTimer::get_available_timer(type);
+  if (ch >= 0) {
+    g_rx_timer.begin(TIMER_MODE_PERIODIC, type, ch, (float)SERIAL_RX_PUMP_HZ, 0.0f, rx_timer_cb);
+    g_rx_isr = g_rx_timer.setup_overflow_irq() && g_rx_timer.open() && g_rx_timer.start();
+  }
+  motion_gate_timer(g_rx_isr);
+  #endif
+}
+
+void serial_rx_poll() {
+  pump();
+}
+
+void serial_rx_block_begin() {
+  pump();
+  #if RX_FROM_ISR
+  g_isr_owns = g_rx_isr;
+  #endif
+}
+
+void serial_rx_block_end() {
+  #if RX_FROM_ISR
+  // The timer preempts us, never the other way round: once the flag is
+  // clear no pump() can still be running
+  g_isr_owns = false;
+  #endif
+  pump();
+}
+
+void serial_rx_sleep() {
+  #if RX_FROM_ISR
+  if (!g_rx_isr || motion_gate_chopping()) return;
+  g_rx_timer.stop();
+  g_rx_paused = true;
+  #endif
+}
+
+void serial_rx_wake() {
+  #if RX_FROM_ISR
+  if (!g_rx_paused) return;
+  g_rx_paused = false;
+  pump(); // whatever woke us, before the next slot: an urgent stop acts now
+  g_rx_timer.start();
+  #endif
+}
+
+bool serial_rx_pending() {
+  return g_lines_in != g_lines_out;
+}
+
+RxLine serial_rx_line(char* out, uint8_t cap) {
+  if (g_lines_in == g_lines_out) return RX_NONE;
+  uint16_t t = g_tail;
+  uint8_t len = 0;
+  bool cut = false;
+  char c;
+  for (;;) {
+    c = (char)g_ring[t & RX_MASK];
+    t++;
+    if (c == '\n' || c == RX_EOL_DAMAGED) break;
+    if (len < cap - 1) out[len++] = c; else cut = true;
+  }
+  out[len] = '\0';
+  g_bytes_out += (uint16_t)(t - g_tail);
+  g_tail = t; // release the slots to the producer
+  g_lines_out++;
+  if (c == RX_EOL_DAMAGED) return RX_DAMAGED;
+  if (cut) { g_truncated++; return RX_TRUNCATED; }
+  return RX_LINE;
+}
+
+void serial_rx_flush() {
+  // Producer state is touched too, so keep the pump out while we reset it
+  noInterrupts();
+  while (Serial.available() > 0) { Serial.read(); g_skipped++; }
+  g_bytes_out += (uint16_t)(g_head - g_tail);
+  g_tail = g_head;
+  g_lines_out = g_lines_in;
+  g_prod_len = 0;
+  g_prod_damaged = false;
+  interrupts();
+}
+
+uint16_t serial_rx_free() { return (uint16_t)(RX_RING_SIZE - (uint16_t)(g_head - g_tail)); }
+uint16_t serial_rx_lines_waiting() { return (uint16_t)(g_lines_in - g_lines_out); }
+uint32_t serial_rx_dropped() { return g_dropped; }
+uint32_t serial_rx_truncated() { return g_truncated; }
+uint32_t serial_rx_urgent() { return g_urgent; }
+uint32_t serial_rx_consumed_bytes() { return g_skipped + g_dropped + g_bytes_out; }
+uint16_t serial_rx_consumed_lines() { return g_lines_out; }
+uint16_t serial_rx_window() { return RX_RING_SIZE - 1; }
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+
+// Single-producer/single-consumer RX ring. The producer drains the serial
+// driver from loop(), and from a periodic timer ISR (SERIAL_RX_ISR) while
+// loop() is stuck in a blocking wait, so bytes and line boundaries are
+// captured no matter how long the pass takes; the consumer is
+// serial_proto_tick(). Urgent stops (S / STOP) cut the motors as the line
+// ends, before it is even dispatched.
+void serial_rx_init();
+void serial_rx_poll();    // producer step from loop()
+// Bracket a blocking wait (pulseIn, a ToF sample). Nothing in between may
+// touch Serial: the timer ISR owns the driver until _end().
+void serial_rx_block_begin();
+void serial_rx_block_end();
+// Asleep in WFI the RX interrupt wakes the loop by itself, so the pump timer
+// only runs while a pass is busy (or the OE gate is chopping on it).
+// Both are called by idle_tick(), sleep with interrupts masked.
+void serial_rx_sleep();
+void serial_rx_wake();
+bool serial_rx_pending(); // a complete line is waiting
+// Result of popping one line. Damaged lines lost bytes to a full ring and
+// truncated ones did not fit the caller's buffer; neither should be executed.
+enum RxLine : uint8_t { RX_NONE = 0, RX_LINE, RX_TRUNCATED, RX_DAMAGED };
+RxLine serial_rx_line(char* out, uint8_t cap); // pop one line (no EOL)
+void serial_rx_flush();   // discard queued lines, the partial line and driver bytes
+
+// Counters for flow-control/health reporting
+uint16_t serial_rx_free();          // free ring bytes
+uint16_t serial_rx_lines_waiting(); // complete lines queued
+uint32_t serial_rx_dropped();       // bytes lost to a full ring
+uint32_t serial_rx_truncated();     // lines cut at the consumer buffer size
+uint32_t serial_rx_urgent();        // urgent stops executed from the ISR
+// Cumulative host bytes/lines taken off the link: queued and popped, skipped
+// (blank EOLs) or dropped. Host credit = window - (sent - consumed).
+uint32_t serial_rx_consumed_bytes();
+uint16_t serial_rx_consumed_lines();
+uint16_t serial_rx_window();        // bytes the host may have in flight
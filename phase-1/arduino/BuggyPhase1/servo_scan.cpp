@@ -5,11 +5,48 @@
 #include "config.h"
 
 static Servo g_servo;
-static int g_target_deg = 90;
-static int g_current_deg = 90;
-static unsigned long g_last_move_ms = 0;
+static int g_target_cdeg = 9000;
+static float g_pos_deg = 90.0f;   // trajectory position = what the horn is commanded to
+static float g_vel_dps = 0.0f;    // signed trajectory velocity
+static float g_max_vel_dps = SERVO_MAX_VEL_DPS;
+static float g_max_acc_dps2 = SERVO_MAX_ACC_DPS2;
+static bool g_moving = false;
+static int g_written_us = -1;
+static unsigned long g_last_tick_us = 0;
+static unsigned long g_last_move_ms = 0; // trajectory arrival time
 static bool g_attached = false;
 static bool g_sweeping = false;
+static int8_t g_sweep_dir = +1;   // +1 toward SWEEP_LEFT_DEG, -1 toward SWEEP_RIGHT_DEG
+static uint16_t g_sweep_pass = 0;
+static float g_sweep_vel_dps = SWEEP_VEL_DPS;
+
+// Recent trajectory points so samples can be tagged with the angle at an
+// earlier instant (echo midpoint minus servo lag)
+#define SERVO_HIST 32
+#define SERVO_HIST_STEP_US 2000UL // ~64 ms of history regardless of loop rate
+static unsigned long g_hist_us[SERVO_HIST];
+static float g_hist_deg[SERVO_HIST];
+static uint8_t g_hist_head = 0;
+static uint8_t g_hist_count = 0;
+
+static void hist_push(unsigned long t_us, float deg) {
+  g_hist_head = (uint8_t)((g_hist_head + 1) % SERVO_HIST);
+  g_hist_us[g_hist_head] = t_us;
+  g_hist_deg[g_hist_head] = deg;
+  if (g_hist_count < SERVO_HIST) g_hist_count++;
+}
+
+static int deg_to_us(float deg) {
+  return SERVO_MIN_US + (int)(deg * (SERVO_MAX_US - SERVO_MIN_US) / 180.0f + 0.5f);
+}
+
+static void write_position() {
+  int us = deg_to_us(g_pos_deg);
+  if (us != g_written_us) {
+    g_servo.writeMicroseconds(us);
+    g_written_us = us;
+  }
+}
 
 void servo_init() {
   // Start detached to avoid idle jitter
@@ -17,34 +54,125 @@ void servo_init() {
   digitalWrite(SERVO_PIN, LOW);
   g_attached = false;
   g_last_move_ms = millis();
+  g_last_tick_us = micros();
 }
 
-void servo_set_target_deg(int deg) {
-  if (deg < 0) deg = 0; if (deg > 180) deg = 180;
-  if (deg != g_target_deg) {
-    g_target_deg = deg;
-    if (!g_attached) { g_servo.attach(SERVO_PIN); g_attached = true; }
-    g_servo.write(g_target_deg);
-    g_current_deg = g_target_deg;
-    g_last_move_ms = millis();
+static void ensure_attached() {
+  if (!g_attached) {
+    g_servo.attach(SERVO_PIN, SERVO_MIN_US, SERVO_MAX_US);
+    g_attached = true;
+    g_written_us = -1;
+    write_position();
+  }
+}
+
+static void move_to(int cdeg) {
+  if (cdeg != g_target_cdeg) {
+    g_target_cdeg = cdeg;
+    ensure_attached();
+    g_moving = true; // servo_tick plans the move from the current velocity
+  }
+}
+
+void servo_set_target_cdeg(int cdeg) {
+  if (cdeg < 0) cdeg = 0; if (cdeg > 18000) cdeg = 18000;
+  if (cdeg != g_target_cdeg) {
+    move_to(cdeg);
     g_sweeping = false; // stop any sweep when explicit target is set
   }
 }
 
+void servo_set_target_deg(int deg) {
+  if (deg < 0) deg = 0; if (deg > 180) deg = 180;
+  servo_set_target_cdeg(deg * 100);
+}
+
 bool servo_is_settled() {
-  return (millis() - g_last_move_ms) >= SERVO_SETTLE_MS && g_current_deg == g_target_deg;
+  return !g_moving && (millis() - g_last_move_ms) >= SERVO_SETTLE_MS;
 }
 
-int servo_get_target_deg() { return g_target_deg; }
-int servo_get_current_deg() { return g_current_deg; }
+int servo_get_target_deg() { return (g_target_cdeg + 50) / 100; }
+int servo_get_target_cdeg() { return g_target_cdeg; }
+int servo_get_current_deg() { return (int)(g_pos_deg + 0.5f); }
+int servo_get_position_cdeg() { return (int)(g_pos_deg * 100.0f + 0.5f); }
+float servo_get_velocity_dps() { return g_vel_dps; }
+
+void servo_set_limits(float max_vel_dps, float max_acc_dps2) {
+  if (max_vel_dps > 0) g_max_vel_dps = max_vel_dps;
+  if (max_acc_dps2 > 0) g_max_acc_dps2 = max_acc_dps2;
+}
+
+void servo_get_limits(float* max_vel_dps, float* max_acc_dps2) {
+  *max_vel_dps = g_max_vel_dps;
+  *max_acc_dps2 = g_max_acc_dps2;
+}
 
 void servo_tick() {
-  // Keep servo attached during runtime for continuous scanning
-  // Detaching causes issues with the autonomous sweep behavior
-  // The servo needs to remain attached to respond quickly to new positions
-  
-  // Note: If jitter becomes an issue, we can add a longer idle timeout
-  // before detaching (e.g., only detach if no movement for 5+ seconds)
+  // Trapezoidal trajectory toward the target: accelerate to the velocity
+  // limit, then brake so the horn arrives with ~zero speed instead of
+  // ringing after a full-step jump.
+  unsigned long now_us = micros();
+  float dt = (now_us - g_last_tick_us) * 1e-6f;
+  g_last_tick_us = now_us;
+  if (g_sweeping && !g_moving) {
+    // Reached one end of the sweep: turn around
+    g_sweep_dir = -g_sweep_dir;
+    g_sweep_pass++;
+    move_to((g_sweep_dir > 0 ? SWEEP_LEFT_DEG : SWEEP_RIGHT_DEG) * 100);
+  }
+  if (!g_moving) return;
+  if (dt > 0.05f) dt = 0.05f; // a blocking call stalled the loop; don't leap
+
+  float target = g_target_cdeg / 100.0f;
+  float d = target - g_pos_deg;
+  float dir = (d >= 0) ? 1.0f : -1.0f;
+  float dist = d * dir;
+  float v = g_vel_dps * dir; // speed toward the target (negative = moving away)
+  float a = g_max_acc_dps2;
+
+  float vmax = g_sweeping && g_sweep_vel_dps < g_max_vel_dps ? g_sweep_vel_dps : g_max_vel_dps;
+
+  v += a * dt;
+  if (v > vmax) v = vmax;
+  float v_brake = sqrtf(2.0f * a * dist); // fastest speed that can still stop at the target
+  if (v > v_brake) v = v_brake;
+
+  float step = v * dt;
+  if (step >= dist || dist < 0.005f) {
+    g_pos_deg = target;
+    g_vel_dps = 0.0f;
+    g_moving = false;
+    g_last_move_ms = millis();
+  } else {
+    g_pos_deg += dir * step;
+    g_vel_dps = dir * v;
+  }
+  write_position();
+  if (!g_moving || g_hist_count == 0 || now_us - g_hist_us[g_hist_head] >= SERVO_HIST_STEP_US) {
+    hist_push(now_us, g_pos_deg);
+  }
+}
+
+float servo_position_at_us(unsigned long t_us, float* vel_dps) {
+  // Walk back from the newest point to the segment that contains t_us
+  if (g_hist_count == 0 || (long)(t_us - g_hist_us[g_hist_head]) >= 0) {
+    if (vel_dps) *vel_dps = g_vel_dps;
+    return g_pos_deg;
+  }
+  uint8_t newer = g_hist_head;
+  for (uint8_t i = 1; i < g_hist_count; i++) {
+    uint8_t older = (uint8_t)((newer + SERVO_HIST - 1) % SERVO_HIST);
+    if ((long)(t_us - g_hist_us[older]) >= 0) {
+      unsigned long span = g_hist_us[newer] - g_hist_us[older];
+      float slope = span ? (g_hist_deg[newer] - g_hist_deg[older]) / (float)span : 0.0f;
+      if (vel_dps) *vel_dps = slope * 1e6f;
+      return g_hist_deg[older] + slope * (float)(t_us - g_hist_us[older]);
+    }
+    newer = older;
+  }
+  // Older than the history: best guess is the oldest point
+  if (vel_dps) *vel_dps = g_vel_dps;
+  return g_hist_deg[newer];
 }
 
 void servo_stopSweep() {
@@ -54,7 +182,21 @@ void servo_stopSweep() {
 }
 
 void servo_startSweep() {
-  g_sweeping = true; // placeholder for future sweep implementation
+  if (g_sweeping) return;
+  ensure_attached();
+  // Head for the farther end first so the first pass is a full one
+  float mid = (SWEEP_LEFT_DEG + SWEEP_RIGHT_DEG) * 0.5f;
+  g_sweep_dir = (g_pos_deg <= mid) ? +1 : -1;
+  g_sweep_pass++;
+  g_sweeping = true;
+  move_to((g_sweep_dir > 0 ? SWEEP_LEFT_DEG : SWEEP_RIGHT_DEG) * 100);
+}
+
+void servo_set_sweep_velocity(float dps) {
+  if (dps > 0) g_sweep_vel_dps = dps;
 }
 
 bool servo_is_sweeping() { return g_sweeping; }
+int servo_sweep_dir() { return g_sweep_dir; }
+uint16_t servo_sweep_pass() { return g_sweep_pass; }
+
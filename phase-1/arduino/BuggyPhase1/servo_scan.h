@@ -3,11 +3,24 @@
 
 void servo_init();
 void servo_set_target_deg(int deg);
+void servo_set_target_cdeg(int cdeg); // 0..18000, sub-degree target
 bool servo_is_settled();
 int servo_get_target_deg();
-int servo_get_current_deg();
+int servo_get_target_cdeg();
+int servo_get_current_deg();          // trajectory position, rounded
+int servo_get_position_cdeg();        // trajectory position in 1/100 deg
+float servo_get_velocity_dps();
+void servo_set_limits(float max_vel_dps, float max_acc_dps2); // <=0 keeps current
+void servo_get_limits(float* max_vel_dps, float* max_acc_dps2);
 void servo_tick();
 
+// Trajectory position at an earlier instant (interpolated over recent ticks)
+float servo_position_at_us(unsigned long t_us, float* vel_dps);
+
+// Continuous sweep between SWEEP_RIGHT_DEG and SWEEP_LEFT_DEG
 void servo_stopSweep();
 void servo_startSweep();
+void servo_set_sweep_velocity(float dps);
 bool servo_is_sweeping();
+int servo_sweep_dir();        // +1 = toward SWEEP_LEFT_DEG
+uint16_t servo_sweep_pass();  // increments at every turnaround
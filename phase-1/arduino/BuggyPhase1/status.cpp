@@ -4,12 +4,11 @@
 #include "ultrasonic.h"
 #include "config.h"
 #include "servo_scan.h"
+#include "battery.h"
+#include "gov.h"
 
+static StatusSnap g_snap;
 static unsigned long g_last_stat_ms = 0;
-static MotionMode g_last_mode = MODE_STOP;
-static int g_last_left_pwm = -1;
-static int g_last_right_pwm = -1;
-static float g_last_cm_sent = NAN;
 static bool g_verbose = true;
 
 void status_init() {
@@ -19,92 +18,131 @@ void status_init() {
   #else
     g_verbose = true;
   #endif
+  status_capture();
 }
 
-void status_tick() {
-  unsigned long now = millis();
-  MotionMode m = motion_get_mode();
-  int lp = motion_left_pwm();
-  int rp = motion_right_pwm();
-  float cm = ultrasonic_last_cm();
-
-  #if BENCH_MODE
-    // In Bench Mode, do not auto-print unless verbose is enabled
-    if (!g_verbose) return;
-  #endif
-
-  // Runtime (or Bench+verbose): emit periodically
-  bool emit = false;
-  if (now - g_last_stat_ms >= STAT_PERIOD_MS) emit = true;
-  if (!emit) return;
+const StatusSnap& status_capture() {
+  // Seqlock reader: the RX ISR may force STOP while the motion fields are
+  // copied; retry so mode and wheel PWMs are from the same side of it
+  uint8_t seq;
+  do {
+    seq = motion_estop_seq();
+    g_snap.mode = motion_get_mode();
+    g_snap.left_pwm = motion_left_pwm();
+    g_snap.right_pwm = motion_right_pwm();
+    g_snap.global_pwm = motion_get_global_pwm();
+  } while (seq != motion_estop_seq());
+  // The ISR cut the outputs; motion_tick has not caught up yet
+  if (g_snap.mode == MODE_STOP) g_snap.left_pwm = g_snap.right_pwm = 0;
+  g_snap.t_ms = millis();
+  g_snap.cm = ultrasonic_last_cm();
+  g_snap.servo_deg = servo_get_current_deg();
+  g_snap.servo_pos_cdeg = servo_get_position_cdeg();
+  g_snap.servo_tgt_cdeg = servo_get_target_cdeg();
+  g_snap.servo_vel_dps = servo_get_velocity_dps();
+  servo_get_limits(&g_snap.servo_vmax, &g_snap.servo_amax);
+  g_snap.servo_settled = servo_is_settled();
+  g_snap.thresh_cm = getSafetyThresholdCM();
+  g_snap.sweeping = servo_is_sweeping();
+  // Never sampled without BATT_MONITOR: all zero
+  g_snap.bat_mv = battery_mv();
+  g_snap.sag_mv = battery_sag_mv();
+  g_snap.bat_rest_mv = battery_rest_mv();
+  g_snap.bat_duty_pct = battery_duty_pct();
+  g_snap.bat_present = battery_present();
+  return g_snap;
+}
 
+// STAT,<mode>,<left>,<right>,<cm|NA>[,BAT=<mv>,SAG=<mv>][,MODE=BENCH]
+static void print_stat_csv(const StatusSnap& s) {
   Serial.print("STAT,");
-  Serial.print(motion_mode_name(m));
+  Serial.print(motion_mode_name(s.mode));
   Serial.print(",");
-  Serial.print(lp);
+  Serial.print(s.left_pwm);
   Serial.print(",");
-  Serial.print(rp);
+  Serial.print(s.right_pwm);
   Serial.print(",");
-  if (isnan(cm)) Serial.print("NA"); else Serial.print(cm, 1);
+  if (isnan(s.cm)) Serial.print("NA"); else Serial.print(s.cm, 1);
+  #if BATT_MONITOR
+    Serial.print(",BAT="); Serial.print(s.bat_mv);
+    Serial.print(",SAG="); Serial.print(s.sag_mv);
+  #endif
   #if BENCH_MODE
     Serial.print(",MODE=BENCH");
   #endif
   Serial.println();
+}
+
+void status_tick() {
+  #if BENCH_MODE
+    // In Bench Mode, do not auto-print unless verbose is enabled
+    if (!g_verbose) return;
+  #endif
 
+  // Runtime (or Bench+verbose): emit periodically, less often over budget
+  unsigned long now = millis();
+  unsigned long since = now - g_last_stat_ms;
+  if (since < STAT_PERIOD_MS) return;
+  GovLevel gov = gov_level();
+  #if BENCH_MODE
+    // Bench telemetry is optional: none at all while over budget
+    if (gov != GOV_OK) { gov_note_shed(); return; }
+  #endif
+  if (gov != GOV_OK && since < STAT_PERIOD_MS * GOV_STAT_STRETCH) { gov_note_shed(); return; }
+  status_capture();
+  print_stat_csv(g_snap);
   g_last_stat_ms = now;
-  g_last_mode = m;
-  g_last_left_pwm = lp;
-  g_last_right_pwm = rp;
-  g_last_cm_sent = cm;
 }
 
 void status_emit_once() {
-  MotionMode m = motion_get_mode();
-  int lp = motion_left_pwm();
-  int rp = motion_right_pwm();
-  float cm = ultrasonic_last_cm();
-  Serial.print("STAT,");
-  Serial.print(motion_mode_name(m));
-  Serial.print(",");
-  Serial.print(lp);
-  Serial.print(",");
-  Serial.print(rp);
-  Serial.print(",");
-  if (isnan(cm)) Serial.print("NA"); else Serial.print(cm, 1);
-  #if BENCH_MODE
-    Serial.print(",MODE=BENCH");
-  #endif
-  Serial.println();
+  status_capture();
+  print_stat_csv(g_snap);
 }
 
 void status_set_verbose(bool on) { g_verbose = on; }
 bool status_get_verbose() { return g_verbose; }
 
-void printStat() {
+void printStat(const StatusSnap& s) {
   // STAT mode=<F|B|L|R|S> spd=<0..255> thresh=<cm or 0> last_cm=<value> sweep=<0|1>
-  MotionMode m = motion_get_mode();
   char modeChar = 'S';
-  switch (m) {
+  switch (s.mode) {
     case MODE_FORWARD_FAST: case MODE_FORWARD_SLOW: modeChar = 'F'; break;
     case MODE_BACK_SLOW: modeChar = 'B'; break;
-    case MODE_ARC_LEFT: case MODE_SPIN_LEFT: modeChar = 'L'; break;
-    case MODE_ARC_RIGHT: case MODE_SPIN_RIGHT: modeChar = 'R'; break;
+    case MODE_ARC_LEFT: case MODE_SPIN_LEFT: case MODE_PIVOT_LEFT:
+    case MODE_FRONT_SPIN_LEFT: case MODE_REAR_SPIN_LEFT: case MODE_SCRUB_SPIN_LEFT: modeChar = 'L'; break;
+    case MODE_ARC_RIGHT: case MODE_SPIN_RIGHT: case MODE_PIVOT_RIGHT:
+    case MODE_FRONT_SPIN_RIGHT: case MODE_REAR_SPIN_RIGHT: case MODE_SCRUB_SPIN_RIGHT: modeChar = 'R'; break;
+    case MODE_WHEELS: modeChar = 'W'; break;
+    case MODE_FOLLOW: modeChar = 'V'; break;
     case MODE_STOP: default: modeChar = 'S'; break;
   }
-  extern uint16_t getSafetyThresholdCM();
-  extern int motion_get_global_pwm();
   Serial.print("STAT mode="); Serial.print(modeChar);
-  Serial.print(" spd="); Serial.print(motion_get_global_pwm());
-  Serial.print(" thresh="); Serial.print(getSafetyThresholdCM());
-  float cm = ultrasonic_last_cm();
-  Serial.print(" last_cm="); if (isnan(cm)) Serial.print(-1); else Serial.print(cm, 1);
-  Serial.print(" sweep="); Serial.println(servo_is_sweeping() ? 1 : 0);
+  Serial.print(" spd="); Serial.print(s.global_pwm);
+  Serial.print(" thresh="); Serial.print(s.thresh_cm);
+  Serial.print(" last_cm="); if (isnan(s.cm)) Serial.print(-1); else Serial.print(s.cm, 1);
+  Serial.print(" sweep="); Serial.println(s.sweeping ? 1 : 0);
+}
+
+void printULS(const StatusSnap& s) {
+  // ULS cm=<val> angle=<deg or -1> t_ms=<capture time>
+  Serial.print("ULS cm="); if (isnan(s.cm)) Serial.print(-1); else Serial.print(s.cm, 1);
+  Serial.print(" angle="); Serial.print(s.servo_deg);
+  Serial.print(" t_ms="); Serial.println(s.t_ms);
+}
+
+void printServo(const StatusSnap& s) {
+  Serial.print("SRV pos_cdeg="); Serial.print(s.servo_pos_cdeg);
+  Serial.print(" tgt_cdeg="); Serial.print(s.servo_tgt_cdeg);
+  Serial.print(" vel_dps="); Serial.print(s.servo_vel_dps, 1);
+  Serial.print(" vmax="); Serial.print(s.servo_vmax, 0);
+  Serial.print(" amax="); Serial.print(s.servo_amax, 0);
+  Serial.print(" settled="); Serial.println(s.servo_settled ? 1 : 0);
 }
 
-void printULS() {
-  // ULS cm=<val> angle=<deg or -1> t_ms=<millis>
-  float cm = ultrasonic_last_cm();
-  Serial.print("ULS cm="); if (isnan(cm)) Serial.print(-1); else Serial.print(cm, 1);
-  Serial.print(" angle="); Serial.print(servo_get_current_deg());
-  Serial.print(" t_ms="); Serial.println(millis());
+void printBat(const StatusSnap& s) {
+  Serial.print("BAT mv="); Serial.print(s.bat_mv);
+  Serial.print(" rest_mv="); Serial.print(s.bat_rest_mv);
+  Serial.print(" sag_mv="); Serial.print(s.sag_mv);
+  Serial.print(" duty_pct="); Serial.print(s.bat_duty_pct);
+  Serial.print(" present="); Serial.println(s.bat_present ? 1 : 0);
 }
@@ -1,14 +1,48 @@
 #pragma once
 #include <Arduino.h>
+#include "motion.h"
+
+// One coherent view of the state the status lines report. Captured at most
+// once per status_tick() (only when a line is due) and before every queried
+// or event-driven line, so all fields of a record come from the same instant.
+// SCN/SCB lines are not rendered from it: each reports a sample or a closed
+// ScanFrame, which is its own fixed record.
+struct StatusSnap {
+  unsigned long t_ms;
+  MotionMode mode;
+  int left_pwm;        // 0 once an ISR stop has landed, even before motion_tick
+  int right_pwm;
+  int global_pwm;
+  float cm;            // last range, NAN = none
+  int servo_deg;
+  int servo_pos_cdeg;
+  int servo_tgt_cdeg;
+  float servo_vel_dps;
+  float servo_vmax;
+  float servo_amax;
+  bool servo_settled;
+  uint16_t thresh_cm;
+  bool sweeping;
+  uint16_t bat_mv;
+  uint16_t sag_mv;
+  uint16_t bat_rest_mv;
+  uint8_t bat_duty_pct;
+  bool bat_present;
+};
 
 void status_init();
 void status_tick();
-void status_emit_once();
+void status_emit_once();   // fresh capture, then one STAT,... line
+const StatusSnap& status_capture();
 
 // Verbosity control: in Bench mode default comes from BENCH_VERBOSE_DEFAULT; in Runtime defaults to verbose
 void status_set_verbose(bool on);
 bool status_get_verbose();
 
-// One-shot formatted printers for compact protocol
-void printStat();
-void printULS();
+// One-shot formatted printers for the query lines. Each renders the snapshot
+// it is handed, so a caller cannot print a stale one: pass status_capture(),
+// once for lines that must agree (Q's STAT and ULS)
+void printStat(const StatusSnap& s);
+void printULS(const StatusSnap& s);
+void printServo(const StatusSnap& s); // SRV pos_cdeg= tgt_cdeg= vel_dps= vmax= amax= settled=
+void printBat(const StatusSnap& s);   // BAT mv= rest_mv= sag_mv= duty_pct= present=
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+#include "teach.h"
+#include "config.h"
+#include "motion.h"
+#include "follow.h"
+
+struct TeachStep {
+  uint32_t at_ms;  // offset from REC,ON
+  uint8_t mode;    // MotionMode
+  uint8_t wheels;  // MODE_WHEELS pattern, 2 bits per wheel (0 hold, 1 fwd, 2 rev)
+  int16_t pwm;     // speed override, -1 = mode tier
+};
+
+enum TeachState : uint8_t { TEACH_IDLE, TEACH_REC, TEACH_PLAY };
+
+static TeachStep g_steps[TEACH_MAX_STEPS];
+static uint8_t g_count = 0;
+static uint32_t g_len_ms = 0;
+static TeachState g_state = TEACH_IDLE;
+static unsigned long g_t0_ms = 0;
+// Replay cursor and the state the last applied step should have left
+static uint8_t g_next = 0;
+static TeachStep g_expect;
+static int g_saved_pwm = -1; // override in force before PLAY, restored after
+
+static uint8_t pack_wheels(const int8_t w[4]) {
+  uint8_t p = 0;
+  for (uint8_t m = 0; m < 4; m++) p |= (uint8_t)(w[m] > 0 ? 1 : (w[m] < 0 ? 2 : 0)) << (2 * m);
+  return p;
+}
+
+static void unpack_wheels(uint8_t p, int8_t w[4]) {
+  for (uint8_t m = 0; m < 4; m++) {
+    uint8_t d = (p >> (2 * m)) & 3u;
+    w[m] = d == 1 ? 1 : (d == 2 ? -1 : 0);
+  }
+}
+
+static void snapshot(TeachStep* s) {
+  MotionMode mode = motion_get_mode();
+  s->mode = (uint8_t)mode;
+  s->pwm = (int16_t)motion_get_pwm_override();
+  s->wheels = 0;
+  if (mode == MODE_WHEELS) {
+    int8_t w[4];
+    motion_get_wheels(w);
+    s->wheels = pack_wheels(w);
+  }
+}
+
+static bool same_state(const TeachStep& a, const TeachStep& b) {
+  return a.mode == b.mode && a.pwm == b.pwm && a.wheels == b.wheels;
+}
+
+void teach_init() {
+  g_state = TEACH_IDLE;
+  g_count = 0;
+  g_len_ms = 0;
+}
+
+// EVT rec=<off|full|follow> steps=<n> ms=<length>
+static void rec_end(const char* why) {
+  g_len_ms = millis() - g_t0_ms;
+  g_state = TEACH_IDLE;
+  Serial.print("EVT rec="); Serial.print(why);
+  Serial.print(" steps="); Serial.print(g_count);
+  Serial.print(" ms="); Serial.println(g_len_ms);
+}
+
+bool teach_rec_start() {
+  if (g_state == TEACH_PLAY) return false;
+  g_state = TEACH_REC;
+  g_t0_ms = millis();
+  g_count = 0;
+  g_len_ms = 0;
+  // Step 0 is the state the run starts from
+  snapshot(&g_steps[0]);
+  g_steps[0].at_ms = 0;
+  g_count = 1;
+  Serial.println("EVT rec=on");
+  return true;
+}
+
+void teach_rec_stop() {
+  if (g_state == TEACH_REC) rec_end("off");
+}
+
+bool teach_recording() { return g_state == TEACH_REC; }
+
+static void rec_tick() {
+  TeachStep now;
+  snapshot(&now);
+  if (same_state(now, g_steps[g_count - 1])) return;
+  // Closed-loop follow output cannot be replayed open-loop
+  if (now.mode == MODE_FOLLOW) { rec_end("follow"); return; }
+  if (g_count >= TEACH_MAX_STEPS) { rec_end("full"); return; }
+  now.at_ms = millis() - g_t0_ms;
+  g_steps[g_count++] = now;
+}
+
+static void apply_step(const TeachStep& s) {
+  if (s.pwm >= 0) motion_pwm_speed((uint8_t)s.pwm); else motion_clear_pwm_speed();
+  if (s.mode == MODE_WHEELS) {
+    int8_t w[4];
+    unpack_wheels(s.wheels, w);
+    motion_set_wheels(w);
+  }
+  motion_set_mode((MotionMode)s.mode);
+  g_expect = s;
+}
+
+static void play_finish() {
+  g_state = TEACH_IDLE;
+  if (g_saved_pwm >= 0) motion_pwm_speed((uint8_t)g_saved_pwm); else motion_clear_pwm_speed();
+}
+
+bool teach_play_start() {
+  if (g_state != TEACH_IDLE || g_count == 0) return false;
+  follow_stop();
+  g_saved_pwm = motion_get_pwm_override();
+  g_state = TEACH_PLAY;
+  g_next = 0;
+  g_t0_ms = millis();
+  Serial.print("EVT play=start steps="); Serial.print(g_count);
+  Serial.print(" ms="); Serial.println(g_len_ms);
+  return true;
+}
+
+bool teach_playing() { return g_state == TEACH_PLAY; }
+
+// EVT play=abort why=<reason> n=<applied>/<steps>
+void teach_play_abort(const char* why) {
+  if (g_state != TEACH_PLAY) return;
+  play_finish();
+  Serial.print("EVT play=abort why="); Serial.print(why);
+  Serial.print(" n="); Serial.print(g_next);
+  Serial.print("/"); Serial.println(g_count);
+}
+
+static void play_tick() {
+  // Something other than the replay moved the motion state (host motion
+  // command, RX-ISR emergency stop): hand control back
+  if (g_next > 0) {
+    TeachStep now;
+    snapshot(&now);
+    if (!same_state(now, g_expect)) { teach_play_abort("override"); return; }
+  }
+  unsigned long t = millis() - g_t0_ms;
+  while (g_next < g_count && g_steps[g_next].at_ms <= t) {
+    apply_step(g_steps[g_next++]);
+    // EVT play=step n=<i>/<steps> t_ms=<offset>: replay progress
+    Serial.print("EVT play=step n="); Serial.print(g_next);
+    Serial.print("/"); Serial.print(g_count);
+    Serial.print(" t_ms="); Serial.println(t);
+  }
+  if (g_next >= g_count && t >= g_len_ms) {
+    motion_set_mode(MODE_STOP);
+    play_finish();
+    Serial.print("EVT play=done ms="); Serial.println(t);
+  }
+}
+
+void teach_tick() {
+  if (g_state == TEACH_REC) rec_tick();
+  else if (g_state == TEACH_PLAY) play_tick();
+}
+
+void printRec() {
+  static const char* const names[] = { "IDLE", "REC", "PLAY" };
+  uint32_t len = g_state == TEACH_REC ? millis() - g_t0_ms : g_len_ms;
+  Serial.print("REC state="); Serial.print(names[g_state]);
+  Serial.print(" steps="); Serial.print(g_count);
+  Serial.print("/"); Serial.print(TEACH_MAX_STEPS);
+  Serial.print(" ms="); Serial.print(len);
+  Serial.print(" at="); Serial.println(g_next);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+
+// Teach-and-repeat. While recording, every change of the applied motion state
+// (mode, speed override, wheel pattern) is logged with its offset from REC,ON
+// into a RAM buffer, whoever caused it (host command, safety stop, watchdog).
+// PLAY re-applies the log on the firmware's own clock. The safety sampler,
+// the watchdog and host commands stay live during a replay; any of them
+// changing the motion state ends it.
+void teach_init();
+void teach_tick(); // after follow_tick(), before motion_tick()
+
+bool teach_rec_start();  // false while a replay runs
+void teach_rec_stop();
+bool teach_recording();
+bool teach_play_start(); // false while recording or with an empty log
+bool teach_playing();
+// Ends a replay without touching the motion state; why = command|safety|watchdog|host
+void teach_play_abort(const char* why);
+
+// REC state=<IDLE|REC|PLAY> steps=<n>/<max> ms=<length> at=<next step>
+void printRec();
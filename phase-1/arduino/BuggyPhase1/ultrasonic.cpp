@@ -1,115 +1,226 @@
 #include <Arduino.h>
 #include "ultrasonic.h"
-#include "pins.h"
+#include "ranger.h"
 #include "config.h"
 #include "motion.h"
 #include "status.h"
 #include "servo_scan.h"
+#include "scan.h"
+#include "follow.h"
+#include "teach.h"
+#include "fields.h"
+#include "gov.h"
 
 static float g_last_cm = NAN;
-static unsigned long g_last_ping_ms = 0;
+static bool g_last_blind = false;       // last sample was a return inside DIST_MIN_CM
 static uint16_t g_safety_thresh_cm = 0; // 0 = disabled
 static uint8_t g_consec_hits = 0;
-static unsigned long g_last_sample_ms = 0;
+// Auto-resume hold: the motion the last safety stop interrupted
+static uint16_t g_resume_cm = SAFETY_RESUME_DEFAULT_CM;
+static uint16_t g_clear_ms = SAFETY_CLEAR_DEFAULT_MS;
+static bool g_held = false;
+static MotionMode g_hold_mode = MODE_STOP;
+static int8_t g_hold_wheels[4];
+static int g_hold_pwm = -1;
+static unsigned long g_hold_ms = 0;     // when the stop fired
+static unsigned long g_clear_since = 0; // first clear reading of the current run, 0 = none
+// Consecutive samples inside the active protective / warning field
+static uint8_t g_field_stop_hits = 0;
+static uint8_t g_field_warn_hits = 0;
+
+// RNG? window
+static unsigned long g_rng_window_us = 0;
+static uint32_t g_rng_samples = 0;
 
 void ultrasonic_init() {
-  pinMode(ULTRASONIC_TRIG, OUTPUT);
-  pinMode(ULTRASONIC_ECHO, INPUT);
+  g_safety_thresh_cm = SAFETY_DEFAULT_CM; // warm boots restore their own value later
+  ranger_init();
 }
 
-static float clamp_cm(float cm) {
-  if (cm < DIST_MIN_CM || cm > DIST_MAX_CM) return NAN;
-  return cm;
+static void note_sample(const RangeSample& s) {
+  g_last_cm = s.cm;
+  g_last_blind = s.blind;
+  g_rng_samples++;
 }
 
 float ultrasonic_measure_cm() {
-  // Respect measurement cooldown
-  if (millis() - g_last_ping_ms < MEAS_COOLDOWN_MS) {
-    return g_last_cm;
-  }
   // Ensure servo is settled before pinging to avoid echo contamination
   extern bool servo_is_settled();
   if (!servo_is_settled()) {
     #if BENCH_MODE
-    Serial.println("DBG uls_measure: servo not settled");
-    #endif
-    g_last_cm = NAN;
-    g_last_ping_ms = millis();
-    return g_last_cm;
-  }
-  digitalWrite(ULTRASONIC_TRIG, LOW);
-  delayMicroseconds(2);
-  digitalWrite(ULTRASONIC_TRIG, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(ULTRASONIC_TRIG, LOW);
-
-  unsigned long duration = pulseIn(ULTRASONIC_ECHO, HIGH, 30000UL);
-  #if BENCH_MODE
-  Serial.print("DBG uls_measure: duration_us=");
-  Serial.println(duration);
-  #endif
-  if (duration == 0) {
-    #if BENCH_MODE
-    Serial.println("DBG uls_measure: TIMEOUT (no echo received)");
+    if (gov_level() == GOV_OK) Serial.println("DBG uls_measure: servo not settled");
     #endif
     g_last_cm = NAN;
-    g_last_ping_ms = millis();
     return g_last_cm;
   }
-  float cm = (float)duration / 58.0f;
-  g_last_cm = clamp_cm(cm);
-  g_last_ping_ms = millis();
-  #if BENCH_MODE
-  Serial.print("DBG uls_measure: raw_cm=");
-  Serial.print(cm, 1);
-  Serial.print(" clamped=");
-  if (isnan(g_last_cm)) Serial.println("NA"); else Serial.println(g_last_cm, 1);
-  #endif
+  RangeSample s;
+  if (!ranger_measure(&s)) return g_last_cm;
+  note_sample(s);
   return g_last_cm;
 }
 
 float ultrasonic_last_cm() { return g_last_cm; }
 
-void ultrasonic_tick() {
-  // Optional background sampler for safety threshold with debounce
-  if (g_safety_thresh_cm == 0) return;
+bool ultrasonic_echo_pending() {
+  return ranger_ready();
+}
+
+static bool resume_enabled() {
+  return g_resume_cm > g_safety_thresh_cm && g_safety_thresh_cm != 0;
+}
+
+void safety_hold_cancel() {
+  g_held = false;
+  g_clear_since = 0;
+}
+
+static void hold_motion() {
+  g_hold_mode = motion_get_mode();
+  motion_get_wheels(g_hold_wheels);
+  g_hold_pwm = motion_get_pwm_override();
+  g_hold_ms = millis();
+  g_clear_since = 0;
+  // Closed-loop and replayed motion cannot simply be re-applied later
+  g_held = resume_enabled() && g_hold_mode != MODE_STOP && g_hold_mode != MODE_FOLLOW &&
+           !teach_playing();
+}
+
+// Clear means a valid reading beyond the resume distance, or no return at all.
+// A return from inside DIST_MIN_CM is not clear.
+static bool path_clear(float cm) {
+  if (isnan(cm)) return !g_last_blind;
+  return cm > (float)g_resume_cm;
+}
+
+static void resume_update(float cm) {
+  // Any other motion command since the stop means the host has taken over
+  if (motion_get_mode() != MODE_STOP || !resume_enabled()) { safety_hold_cancel(); return; }
+  if (!path_clear(cm)) { g_clear_since = 0; return; }
   unsigned long now = millis();
-  if (now - g_last_sample_ms < 80) return;
-  g_last_sample_ms = now;
-  float cm = readUltrasonicCM();
+  if (g_clear_since == 0) { g_clear_since = now ? now : 1; return; }
+  if (now - g_clear_since < g_clear_ms) return;
+  g_held = false;
+  g_clear_since = 0;
+  if (g_hold_pwm >= 0) motion_pwm_speed((uint8_t)g_hold_pwm);
+  else motion_clear_pwm_speed();
+  if (g_hold_mode == MODE_WHEELS) motion_set_wheels(g_hold_wheels);
+  motion_set_mode(g_hold_mode);
+  Serial.print("EVT resume=safety mode="); Serial.print(motion_mode_name(g_hold_mode));
+  Serial.print(" held_ms="); Serial.println(now - g_hold_ms);
+}
+
+// Shared by the threshold and the fields; the caller prints the EVT
+static void safety_stop(const char* why) {
+  hold_motion();
+  teach_play_abort(why);
+  motion_set_mode(MODE_STOP);
+  status_emit_once();
+}
+
+static void safety_update(float cm) {
   if (!isnan(cm) && cm > 0 && cm < (float)g_safety_thresh_cm) {
     if (g_consec_hits < 255) g_consec_hits++;
   } else {
     g_consec_hits = 0;
   }
+  if (g_held) {
+    // Already stopped for this obstacle: wait for the path to clear
+    resume_update(cm);
+    g_consec_hits = 0;
+    return;
+  }
   if (g_consec_hits >= 3) {
     // 3-hit debounce: trigger STOP once
-    motion_set_mode(MODE_STOP);
-    status_emit_once();
+    safety_stop("safety");
     Serial.println("EVT stop=safety");
     g_consec_hits = 0;
   }
 }
 
-float readUltrasonicCM() {
-  digitalWrite(ULTRASONIC_TRIG, LOW);
-  delayMicroseconds(2);
-  digitalWrite(ULTRASONIC_TRIG, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(ULTRASONIC_TRIG, LOW);
-  unsigned long duration = pulseIn(ULTRASONIC_ECHO, HIGH, 30000UL);
-  if (duration == 0) {
-    g_last_cm = NAN;
-    return g_last_cm;
-  }
-  float cm = (float)duration / 58.0f;
-  if (cm < DIST_MIN_CM || cm > DIST_MAX_CM) {
-    g_last_cm = NAN;
-  } else {
-    g_last_cm = cm;
+// Fields are judged at the angle the horn faced when the range formed
+static void field_update(const RangeSample& s) {
+  FieldProfile p = fields_profile();
+  float deg = servo_position_at_us(s.mid_us, NULL);
+  FieldLevel lv = fields_check(p, s.cm, deg);
+  if (lv == FIELD_STOP) { if (g_field_stop_hits < 255) g_field_stop_hits++; } else g_field_stop_hits = 0;
+  if (lv != FIELD_CLEAR) { if (g_field_warn_hits < 255) g_field_warn_hits++; } else g_field_warn_hits = 0;
+  if (g_field_stop_hits >= FIELD_HITS) {
+    safety_stop("field");
+    Serial.print("EVT stop=field fld="); Serial.print(fields_profile_name(p));
+    Serial.print(" deg="); Serial.print((int)deg);
+    Serial.print(" cm="); Serial.println((int)s.cm);
+    g_field_stop_hits = g_field_warn_hits = 0;
+  } else if (g_field_warn_hits >= FIELD_HITS && motion_duty_permille() >= FIELD_FAST_DUTY_PCT * 10) {
+    // Cap the duty under the tier, so arcs keep their pulsed inner side; the
+    // host decides when to speed up again
+    teach_play_abort("field");
+    motion_limit_duty(FIELD_SLOW_DUTY_PCT * 10);
+    Serial.print("EVT slow=field fld="); Serial.print(fields_profile_name(p));
+    Serial.print(" deg="); Serial.print((int)deg);
+    Serial.print(" cm="); Serial.println((int)s.cm);
+    g_field_warn_hits = 0;
   }
+}
+
+static void handle_sample(const RangeSample& s, bool sweeping) {
+  note_sample(s);
+  if (sweeping) scan_add_ping(s.cm, s.mid_us, s.span_us);
+  if (g_safety_thresh_cm != 0) safety_update(s.cm);
+  if (fields_active()) field_update(s);
+  else g_field_stop_hits = g_field_warn_hits = 0;
+}
+
+void ultrasonic_tick() {
+  // Background sampler: safety threshold with debounce, fields, continuous sweep and/or follow ranging
+  bool sweeping = servo_is_sweeping();
+  bool urgent = g_safety_thresh_cm != 0 || follow_active() || fields_active();
+  if (!urgent && !sweeping) { ranger_stop(); return; }
+  // Sweep-only ranging waits out an overload; a finished sample is still taken
+  if (!urgent && gov_level() == GOV_SHED && !ranger_ready()) { gov_note_shed(); return; }
+  RangeSample s;
+  if (ranger_poll(&s, sweeping)) handle_sample(s, sweeping);
+}
+
+// Rate counts completed samples; back-end fields follow gap_ms
+void printRng() {
+  unsigned long now = micros();
+  unsigned long span = now - g_rng_window_us;
+  float hz = span ? g_rng_samples * 1e6f / span : 0.0f;
+  Serial.print("RNG hz="); Serial.print(hz, 1);
+  Serial.print(" gap_ms="); Serial.print(ranger_gap_us(servo_is_sweeping()) / 1000.0f, 1);
+  ranger_print_stats();
+  Serial.print(" src="); Serial.println(ranger_name());
+  g_rng_window_us = now;
+  g_rng_samples = 0;
+}
+
+float readUltrasonicCM() {
+  RangeSample s;
+  if (!ranger_measure(&s)) return g_last_cm;
+  note_sample(s);
   return g_last_cm;
 }
 
-void setSafetyThresholdCM(uint16_t cm) { g_safety_thresh_cm = cm; }
+void setSafetyThresholdCM(uint16_t cm) {
+  g_safety_thresh_cm = cm;
+  if (!resume_enabled()) safety_hold_cancel();
+}
 uint16_t getSafetyThresholdCM() { return g_safety_thresh_cm; }
+
+void setSafetyResume(uint16_t resume_cm, uint16_t clear_ms) {
+  g_resume_cm = resume_cm;
+  g_clear_ms = clear_ms;
+  if (!resume_enabled()) safety_hold_cancel();
+}
+uint16_t getSafetyResumeCM() { return g_resume_cm; }
+uint16_t getSafetyClearMs() { return g_clear_ms; }
+
+void printSafe() {
+  const char* state = g_safety_thresh_cm == 0 ? "OFF" : (g_held ? "HOLD" : "ARMED");
+  Serial.print("SAFE stop="); Serial.print(g_safety_thresh_cm);
+  Serial.print(" resume="); Serial.print(resume_enabled() ? g_resume_cm : 0);
+  Serial.print(" clear_ms="); Serial.print(g_clear_ms);
+  Serial.print(" state="); Serial.print(state);
+  Serial.print(" hold="); Serial.print(g_held ? motion_mode_name(g_hold_mode) : "-");
+  Serial.print(" clear_for="); Serial.println(g_clear_since ? millis() - g_clear_since : 0UL);
+}
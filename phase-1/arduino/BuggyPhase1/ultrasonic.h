@@ -5,8 +5,18 @@ void ultrasonic_init();
 void ultrasonic_tick();
 float ultrasonic_measure_cm();
 float ultrasonic_last_cm();
+bool ultrasonic_echo_pending(); // background sample completed, not yet consumed
+void printRng();                // RNG hz= gap_ms= <back-end fields> src= (resets the rate window)
 
 // Compact on-demand API
 float readUltrasonicCM();
 void setSafetyThresholdCM(uint16_t cm); // 0 disables
 uint16_t getSafetyThresholdCM();
+
+// Hysteretic resume: hold the motion a safety stop interrupted and re-apply it
+// after the path reads beyond resume_cm for clear_ms (resume_cm 0 = latch)
+void setSafetyResume(uint16_t resume_cm, uint16_t clear_ms);
+uint16_t getSafetyResumeCM();
+uint16_t getSafetyClearMs();
+void safety_hold_cancel();      // S, watchdog, host loss: never resume after these
+void printSafe();               // SAFE stop= resume= clear_ms= state=<OFF|ARMED|HOLD> hold=<mode> clear_for=
@@ -3,6 +3,8 @@
 #include "config.h"
 #include "motion.h"
 #include "status.h"
+#include "teach.h"
+#include "ultrasonic.h"
 
 static unsigned long g_last_hb_ms = 0;
 static bool g_latched = false;
@@ -16,6 +18,8 @@ void watchdog_tick() {
   // via higher-level integration, we can periodically force STOP here.
   unsigned long now = millis();
   if (!g_latched && (now - g_last_hb_ms > HB_TIMEOUT_MS)) {
+    teach_play_abort("watchdog");
+    safety_hold_cancel();
     motion_set_mode(MODE_STOP);
     // Emit a one-shot reasoned STAT only in Runtime Mode (Bench is already permissive)
     #if BENCH_MODE
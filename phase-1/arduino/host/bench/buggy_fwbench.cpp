@@ -0,0 +1,346 @@
+// buggy_fwbench: runs BuggyPhase1 and the testing/ sketches on the host HAL
+// with the same simulated shield and sensor, drives each through equivalent
+// workloads and prints their latch, ranging and command figures side by side.
+//
+//   buggy_fwbench [--trials 40] [--seconds 5] [--map room] [--seed 1]
+//
+// Every trial is a fresh boot in a forked child, so sketch globals never leak
+// between trials. Times are virtual, from the HAL cost model.
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../hal/hal.hpp"
+#include "../sim/rig.hpp"
+#include "sketches.hpp"
+
+using namespace buggy;
+using namespace buggy::bench;
+
+namespace {
+
+constexpr uint64_t kMs = 1000000ULL;
+constexpr uint64_t kBootNs = 300 * kMs;     // boot settle before the first command
+constexpr uint64_t kArmNs = 300 * kMs;      // arm -> first drive command
+constexpr uint64_t kHoldNs = 150 * kMs;     // drive time before STOP
+constexpr uint64_t kTimeoutNs = 1000 * kMs;  // a command that takes longer counts as lost
+constexpr uint64_t kHbNs = 200 * kMs;
+
+struct Options {
+  int trials = 40;
+  double seconds = 5.0;
+  std::string map = "room";
+  uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    const char* v = argv[i + 1];
+    if (k == "--trials") o.trials = std::max(1, std::atoi(v));
+    else if (k == "--seconds") o.seconds = std::max(0.5, std::atof(v));
+    else if (k == "--map") o.map = v;
+    else if (k == "--seed") o.seed = (uint32_t)std::strtoul(v, nullptr, 10);
+    else std::fprintf(stderr, "buggy_fwbench: ignoring %s\n", k.c_str());
+  }
+  return o;
+}
+
+// One commanded change of the motor latch, from the command's last RX byte
+// until every wheel shows the target direction
+struct Change {
+  double latency_ms = NAN;
+  int commits = 0;
+  int transients = 0;  // latched values that were neither the old nor the new state
+  double span_us = 0.0;  // first commit -> settled
+};
+
+struct DriveResult {
+  int ok = 0;
+  Change go, stop;
+  double commit_us = 0.0;  // LATCH low -> high, summed over commit_n
+  int commit_n = 0;
+};
+
+struct RangeResult {
+  int ok = 0;
+  uint32_t pings = 0;
+  double seconds = 0.0;
+  double gap_p50_ms = NAN;
+  double gap_max_ms = NAN;
+};
+
+// Runs fn in a child so each trial boots the sketch from pristine globals
+template <class R, class Fn>
+R run_forked(Fn fn) {
+  static_assert(std::is_trivially_copyable<R>::value, "result crosses a pipe");
+  R out;
+  int fds[2];
+  if (pipe(fds) != 0) { perror("pipe"); return out; }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    R r = fn();
+    ssize_t n = write(fds[1], &r, sizeof(r));
+    _exit(n == (ssize_t)sizeof(r) ? 0 : 1);
+  }
+  close(fds[1]);
+  if (pid < 0) { perror("fork"); close(fds[0]); return out; }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (read(fds[0], &out, sizeof(out)) != (ssize_t)sizeof(out)) out = R();
+  close(fds[0]);
+  return out;
+}
+
+bool wheels_are(const sim::Rig& rig, int dir) {
+  for (int m = 0; m < 4; m++)
+    if (rig.wheel_dir(m) != dir) return false;
+  return true;
+}
+
+// Watches latch commits for the change in flight
+class Watch {
+ public:
+  void start(uint64_t cmd_end_ns, int target, uint8_t before, Change* out) {
+    cmd_end_ns_ = cmd_end_ns;
+    target_ = target;
+    before_ = before;
+    out_ = out;
+    seen_.clear();
+    first_ns_ = 0;
+  }
+  Change* current() const { return out_; }
+
+  // true once the change has settled
+  bool commit(const sim::Rig& rig, uint8_t value) {
+    uint64_t now = hal::now_ns();
+    if (!out_ || now < cmd_end_ns_) return false;
+    if (!first_ns_) first_ns_ = now;
+    out_->commits++;
+    seen_.insert(value);
+    if (!wheels_are(rig, target_)) return false;
+    out_->latency_ms = (now - cmd_end_ns_) * 1e-6;
+    out_->span_us = (now - first_ns_) * 1e-3;
+    seen_.erase(before_);
+    seen_.erase(value);
+    out_->transients = (int)seen_.size();
+    out_ = nullptr;
+    return true;
+  }
+
+ private:
+  uint64_t cmd_end_ns_ = 0, first_ns_ = 0;
+  int target_ = 0;
+  uint8_t before_ = 0;
+  Change* out_ = nullptr;
+  std::set<uint8_t> seen_;
+};
+
+void heartbeat(const char* hb) {
+  hal::serial_send(std::string(hb) + "\n");
+  hal::at_ns(hal::now_ns() + kHbNs, [hb] { heartbeat(hb); });
+}
+
+// Boot, arm, drive forward, stop. Sketches without a drive command are
+// stopped while their own demo has the wheels turning.
+DriveResult run_drive(const Sketch& sk, const Options& o, int trial) {
+  DriveResult res;
+  sim::Map map;
+  if (!sim::make_map(o.map, o.seed, &map)) return res;
+  hal::reset();
+  sim::Rig rig(map, sim::RigParams(), o.seed + trial);
+  rig.attach();
+  std::mt19937 rng(o.seed * 7919u + trial);
+  // Spread the command phase across the sketches' loop and ranging periods
+  const uint64_t jitter = std::uniform_int_distribution<uint64_t>(0, 100 * kMs)(rng);
+
+  Watch watch;
+  bool done = false;
+  uint8_t latch = 0;
+  auto finish = [&] {
+    done = true;
+    hal::set_deadline_ns(hal::now_ns() + 1);  // unwind a loop() that never returns
+  };
+  auto send_stop = [&] {
+    if (!sk.go && !wheels_are(rig, 1)) { finish(); return; }  // demo not driving straight yet
+    watch.start(hal::serial_send(std::string(sk.stop) + "\n"), 0, latch, &res.stop);
+    hal::at_ns(hal::now_ns() + kTimeoutNs, [&] { if (!done) finish(); });
+  };
+  rig.on_latch([&](uint8_t value, uint64_t open_ns) {
+    latch = value;
+    Change* ch = watch.current();
+    if (!ch) return;
+    if (open_ns) { res.commit_us += (hal::now_ns() - open_ns) * 1e-3; res.commit_n++; }
+    if (!watch.commit(rig, value)) return;
+    if (ch == &res.go) hal::at_ns(hal::now_ns() + kHoldNs, send_stop);
+    else finish();
+  });
+
+  try {
+    sk.setup();
+    const uint64_t t0 = hal::now_ns() + kBootNs;
+    if (sk.heartbeat) hal::at_ns(hal::now_ns(), [&] { heartbeat(sk.heartbeat); });
+    if (sk.arm) hal::at_ns(t0, [&] { hal::serial_send(std::string(sk.arm) + "\n"); });
+    const uint64_t t1 = t0 + kArmNs + jitter;
+    if (sk.go) {
+      hal::at_ns(t1, [&] { watch.start(hal::serial_send(std::string(sk.go) + "\n"), 1, latch, &res.go); });
+      hal::at_ns(t1 + kTimeoutNs, [&] { if (std::isnan(res.go.latency_ms)) finish(); });
+    } else {
+      hal::at_ns(t1, send_stop);
+    }
+    hal::set_deadline_ns(t1 + 3 * kTimeoutNs);
+    while (!done) {
+      sk.loop();
+      hal::spend_us(hal::costs().loop_pass_us);
+    }
+  } catch (const hal::Deadline&) {
+  }
+  res.ok = 1;
+  return res;
+}
+
+double percentile(std::vector<double> v, double q) {
+  if (v.empty()) return NAN;
+  std::sort(v.begin(), v.end());
+  size_t i = (size_t)std::ceil(q * v.size());
+  return v[std::min(v.size(), std::max<size_t>(i, 1)) - 1];
+}
+
+// Ranging with the motors off: how often does the sketch get a ping out
+RangeResult run_range(const Sketch& sk, const Options& o) {
+  RangeResult res;
+  sim::Map map;
+  if (!sk.range_on || !sim::make_map(o.map, o.seed, &map)) return res;
+  hal::reset();
+  sim::Rig rig(map, sim::RigParams(), o.seed);
+  rig.attach();
+  std::vector<double> at_ms;
+  uint64_t from = 0, to = 0;
+  rig.on_ping([&] {
+    uint64_t now = hal::now_ns();
+    if (from && now >= from && now < to) at_ms.push_back(now * 1e-6);
+  });
+  try {
+    sk.setup();
+    const uint64_t t0 = hal::now_ns() + kBootNs;
+    if (sk.heartbeat) hal::at_ns(hal::now_ns(), [&] { heartbeat(sk.heartbeat); });
+    hal::at_ns(t0, [&] { hal::serial_send(std::string(sk.range_on) + "\n"); });
+    from = t0 + kArmNs;  // let the first pings and any servo move settle
+    to = from + (uint64_t)(o.seconds * 1e9);
+    hal::set_deadline_ns(to);
+    for (;;) {
+      sk.loop();
+      hal::spend_us(hal::costs().loop_pass_us);
+    }
+  } catch (const hal::Deadline&) {
+  }
+  std::vector<double> gaps;
+  for (size_t i = 1; i < at_ms.size(); i++) gaps.push_back(at_ms[i] - at_ms[i - 1]);
+  res.ok = 1;
+  res.pings = (uint32_t)at_ms.size();
+  res.seconds = o.seconds;
+  res.gap_p50_ms = percentile(gaps, 0.5);
+  res.gap_max_ms = gaps.empty() ? NAN : *std::max_element(gaps.begin(), gaps.end());
+  return res;
+}
+
+struct Column {
+  const Sketch* sk;
+  int trials = 0;
+  std::vector<double> go_ms, stop_ms;
+  int lost = 0;
+  double commits = 0, transients = 0, span_us = 0;
+  int changes = 0;
+  double commit_us = 0;
+  int commit_n = 0;
+  RangeResult range;
+};
+
+void add_change(Column* c, const Change& ch, std::vector<double>* lat) {
+  if (std::isnan(ch.latency_ms)) return;
+  lat->push_back(ch.latency_ms);
+  c->commits += ch.commits;
+  c->transients += ch.transients;
+  c->span_us += ch.span_us;
+  c->changes++;
+}
+
+std::string cell(double v, const char* fmt = "%.2f") {
+  if (std::isnan(v)) return "n/a";
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), fmt, v);
+  return buf;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o = parse_args(argc, argv);
+  sim::Map probe;
+  if (!sim::make_map(o.map, o.seed, &probe)) { std::fprintf(stderr, "buggy_fwbench: unknown map %s\n", o.map.c_str()); return 2; }
+
+  std::vector<Column> cols;
+  for (const Sketch* sk : { &kPhase1, &kTestbench, &kServoMovement, &kMovementR4 }) {
+    Column c;
+    c.sk = sk;
+    for (int t = 0; t < o.trials; t++) {
+      DriveResult r = run_forked<DriveResult>([&] { return run_drive(*sk, o, t); });
+      if (!r.ok) continue;
+      c.trials++;
+      if (sk->go) {
+        if (std::isnan(r.go.latency_ms)) c.lost++;
+        add_change(&c, r.go, &c.go_ms);
+      }
+      if (r.stop.commits || !std::isnan(r.stop.latency_ms)) {
+        if (std::isnan(r.stop.latency_ms)) c.lost++;
+        add_change(&c, r.stop, &c.stop_ms);
+      }
+      c.commit_us += r.commit_us;
+      c.commit_n += r.commit_n;
+    }
+    c.range = run_forked<RangeResult>([&] { return run_range(*sk, o); });
+    cols.push_back(c);
+  }
+
+  std::printf("buggy_fwbench: %d drive trials per sketch, %.1f s ranging, map %s (virtual time)\n\n", o.trials,
+              o.seconds, o.map.c_str());
+  std::printf("%-34s", "");
+  for (const Column& c : cols) std::printf("%18s", c.sk->name);
+  std::printf("\n");
+  auto row = [&](const char* label, auto value) {
+    std::printf("%-34s", label);
+    for (const Column& c : cols) std::printf("%18s", value(c).c_str());
+    std::printf("\n");
+  };
+  auto mean = [](double sum, int n) { return n ? sum / n : NAN; };
+
+  row("latch commits per drive change", [&](const Column& c) { return cell(mean(c.commits, c.changes), "%.1f"); });
+  row("latch transient states per change", [&](const Column& c) { return cell(mean(c.transients, c.changes), "%.1f"); });
+  row("latch change span (us)", [&](const Column& c) { return cell(mean(c.span_us, c.changes), "%.0f"); });
+  row("latch commit cost (us)", [&](const Column& c) { return cell(mean(c.commit_us, c.commit_n), "%.1f"); });
+  row("ranging pings/s (motors off)", [&](const Column& c) {
+    return cell(c.range.ok ? c.range.pings / c.range.seconds : NAN, "%.1f");
+  });
+  row("ranging gap p50 (ms)", [&](const Column& c) { return cell(c.range.gap_p50_ms, "%.1f"); });
+  row("ranging gap max (ms)", [&](const Column& c) { return cell(c.range.gap_max_ms, "%.1f"); });
+  row("go latency p50 (ms)", [&](const Column& c) { return cell(percentile(c.go_ms, 0.5)); });
+  row("go latency p99 (ms)", [&](const Column& c) { return cell(percentile(c.go_ms, 0.99)); });
+  row("stop latency p50 (ms)", [&](const Column& c) { return cell(percentile(c.stop_ms, 0.5)); });
+  row("stop latency p99 (ms)", [&](const Column& c) { return cell(percentile(c.stop_ms, 0.99)); });
+  row("commands lost (> 1 s)", [&](const Column& c) { return cell(c.lost, "%.0f"); });
+  std::printf("\nLatency runs from the command's last RX byte to the latch commit that puts every wheel in the\n"
+              "target direction. Transient states are intermediate latch values the motors saw on the way.\n");
+  return 0;
+}
@@ -0,0 +1,21 @@
+// testing/legacy-arduino-code/test_movement_r4.ino: a scripted brake/coast
+// demo that starts driving on boot; STOP is its only motion command
+#include <Arduino.h>
+
+#include "sketches.hpp"
+
+namespace legacy_movement_r4 {
+// The sketch's per-motor EN table is commented out upstream; this shield has
+// no EN pins, so point them all at a pin the HAL ignores
+uint8_t M_EN[4] = { 255, 255, 255, 255 };
+#include "test_movement_r4.ino"
+}  // namespace legacy_movement_r4
+
+namespace buggy {
+namespace bench {
+
+const Sketch kMovementR4 = { "test_movement_r4", legacy_movement_r4::setup, legacy_movement_r4::loop, nullptr,
+                             nullptr,            "STOP",                    nullptr,                  nullptr };
+
+}  // namespace bench
+}  // namespace buggy
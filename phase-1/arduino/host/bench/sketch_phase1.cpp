@@ -0,0 +1,13 @@
+// BuggyPhase1, linked from buggy_fw_tunable with its shipped defaults
+#include "sketches.hpp"
+
+void setup();
+void loop();
+
+namespace buggy {
+namespace bench {
+
+const Sketch kPhase1 = { "BuggyPhase1", setup, loop, "T10", "F,FAST", "STOP", "T10", "HB" };
+
+}  // namespace bench
+}  // namespace buggy
@@ -0,0 +1,20 @@
+// testing/full-buggy-test-bed/arduino/Servo_Movement.ino: always ranging; T10
+// keeps its 25 cm default safety stop out of the drive trials
+#include <Arduino.h>
+#include <Servo.h>
+
+#include "sketches.hpp"
+
+namespace legacy_servo_movement {
+#include "Servo_Movement.ino"
+}  // namespace legacy_servo_movement
+
+namespace buggy {
+namespace bench {
+
+const Sketch kServoMovement = { "Servo_Movement", legacy_servo_movement::setup, legacy_servo_movement::loop,
+                                "T10",            "F200",                       "S",
+                                "T10",            nullptr };
+
+}  // namespace bench
+}  // namespace buggy
@@ -0,0 +1,19 @@
+// testing/.../buggy_testbench.ino: MOVE/ULTRASONIC sessions block loop() and
+// only ABORT is read while one runs, so it cannot range and drive at once
+#include <Arduino.h>
+#include <Servo.h>
+
+#include "sketches.hpp"
+
+namespace legacy_testbench {
+#include "buggy_testbench.ino"
+}  // namespace legacy_testbench
+
+namespace buggy {
+namespace bench {
+
+const Sketch kTestbench = { "buggy_testbench", legacy_testbench::setup, legacy_testbench::loop, nullptr,
+                            "MOVE FWD 600",    "ABORT",                 "ULTRASONIC ON 600",    nullptr };
+
+}  // namespace bench
+}  // namespace buggy
@@ -0,0 +1,24 @@
+#pragma once
+// Firmwares buggy_fwbench compares. Each one is compiled unmodified against
+// the host HAL; the strings are its own protocol's equivalent of each step.
+namespace buggy {
+namespace bench {
+
+struct Sketch {
+  const char* name;
+  void (*setup)();
+  void (*loop)();
+  const char* arm;        // sent once after boot: background ranging on (nullptr = none)
+  const char* go;         // drive forward (nullptr = the sketch drives by itself)
+  const char* stop;
+  const char* range_on;   // continuous ranging with the motors off (nullptr = cannot range)
+  const char* heartbeat;  // resent every 200 ms (nullptr = no link watchdog)
+};
+
+extern const Sketch kPhase1;
+extern const Sketch kTestbench;
+extern const Sketch kServoMovement;
+extern const Sketch kMovementR4;
+
+}  // namespace bench
+}  // namespace buggy
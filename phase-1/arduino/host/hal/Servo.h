@@ -0,0 +1,21 @@
+#pragma once
+// Host Servo: records the commanded pulse per pin for the simulator
+#include <Arduino.h>
+
+class Servo {
+ public:
+  uint8_t attach(int pin) { return attach(pin, 544, 2400); }
+  uint8_t attach(int pin, int min_us, int max_us);
+  void detach();
+  void write(int value);
+  void writeMicroseconds(int us);
+  int read();
+  int readMicroseconds() { return us_; }
+  bool attached() { return pin_ >= 0; }
+
+ private:
+  int pin_ = -1;
+  int min_us_ = 544;
+  int max_us_ = 2400;
+  int us_ = 1500;
+};
@@ -0,0 +1,60 @@
+#pragma once
+// Host String and F(): the subset of the Arduino WString API the testing/
+// sketches use, backed by std::string. Flash strings are plain pointers here.
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class String {
+ public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const __FlashStringHelper* s) : String(reinterpret_cast<const char*>(s)) {}
+  explicit String(char c) : s_(1, c) {}
+
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  const char* c_str() const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : '\0'; }
+
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(const char* s) { s_ += s; return *this; }
+  String& operator+=(const String& s) { s_ += s.s_; return *this; }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return !(*this == o); }
+  bool operator!=(const char* o) const { return !(*this == o); }
+
+  bool startsWith(const String& prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+  bool endsWith(const String& suffix) const {
+    return s_.size() >= suffix.s_.size() && s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t i = s_.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  // Arduino swaps reversed bounds and clips both to the length
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from > s_.size()) return String();
+    return String(s_.substr(from, to - from).c_str());
+  }
+  String substring(unsigned int from) const { return substring(from, length()); }
+
+  void trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n\f\v");
+    if (b == std::string::npos) { s_.clear(); return; }
+    s_ = s_.substr(b, s_.find_last_not_of(" \t\r\n\f\v") - b + 1);
+  }
+  void toUpperCase() { for (char& c : s_) if (c >= 'a' && c <= 'z') c -= 'a' - 'A'; }
+  void toLowerCase() { for (char& c : s_) if (c >= 'A' && c <= 'Z') c += 'a' - 'A'; }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+
+ private:
+  std::string s_;
+};
@@ -0,0 +1,431 @@
+#include <Arduino.h>
+#include <Servo.h>
+#include "hal.hpp"
+
+#include <deque>
+#include <queue>
+#include <vector>
+
+namespace buggy {
+namespace hal {
+namespace {
+
+struct Pending {
+  uint64_t t;
+  uint64_t seq;
+  bool wake;
+  Event fn;
+};
+struct Later {
+  bool operator()(const Pending& a, const Pending& b) const {
+    return a.t != b.t ? a.t > b.t : a.seq > b.seq;
+  }
+};
+
+struct Irq {
+  void (*fn)() = nullptr;
+  int mode = 0;
+};
+
+CostModel g_costs;
+Counters g_counters;
+std::priority_queue<Pending, std::vector<Pending>, Later> g_events;
+uint64_t g_now = 0;
+uint64_t g_seq = 0;
+bool g_dispatching = false;
+uint64_t g_deadline = 0;
+
+int g_level[HAL_NUM_PINS];
+double g_duty[HAL_NUM_PINS];
+Irq g_irq[HAL_NUM_PINS];
+bool g_irq_enabled = true;
+std::vector<void (*)()> g_irq_pending;
+int g_adc_bits = 10;
+
+std::deque<uint8_t> g_rx;
+uint64_t g_rx_last_ns = 0;
+uint64_t g_tx_free_ns = 0;
+std::string g_tx_line;
+bool g_line_up = true;
+
+std::function<void(uint8_t, int)> g_pin_hook;
+std::function<void(uint8_t, int)> g_analog_write_hook;
+std::function<int(uint8_t, int)> g_analog_read_hook;
+std::function<void(uint8_t, int)> g_servo_hook;
+std::function<void(const std::string&)> g_line_hook;
+
+uint64_t byte_ns() { return 10ULL * 1000000000ULL / g_costs.baud; }
+
+// Dispatch events up to target; with stop_on_wake, return after the first
+// wake event instead of moving the clock on to target
+bool run_until(uint64_t target, bool stop_on_wake) {
+  while (!g_events.empty() && g_events.top().t <= target) {
+    Pending p = g_events.top();
+    g_events.pop();
+    if (p.t > g_now) g_now = p.t;
+    g_dispatching = true;
+    p.fn();
+    g_dispatching = false;
+    if (stop_on_wake && p.wake) return true;
+  }
+  if (target > g_now) g_now = target;
+  return false;
+}
+
+void run_isr(void (*fn)()) {
+  g_counters.isr_calls++;
+  spend_us(g_costs.isr_entry_us);
+  fn();
+}
+
+bool pin_ok(uint8_t pin) { return pin < HAL_NUM_PINS; }
+
+void check_deadline() {
+  if (g_deadline && g_now >= g_deadline && !g_dispatching) throw Deadline();
+}
+
+}  // namespace
+
+CostModel& costs() { return g_costs; }
+Counters& counters() { return g_counters; }
+
+void reset() {
+  g_counters = Counters();
+  g_events = decltype(g_events)();
+  g_now = 0;
+  g_seq = 0;
+  g_dispatching = false;
+  g_deadline = 0;
+  for (int i = 0; i < HAL_NUM_PINS; i++) { g_level[i] = LOW; g_duty[i] = 0.0; g_irq[i] = Irq(); }
+  g_irq_enabled = true;
+  g_irq_pending.clear();
+  g_adc_bits = 10;
+  g_rx.clear();
+  g_rx_last_ns = 0;
+  g_tx_free_ns = 0;
+  g_tx_line.clear();
+  g_line_up = true;
+  g_pin_hook = nullptr;
+  g_analog_write_hook = nullptr;
+  g_analog_read_hook = nullptr;
+  g_servo_hook = nullptr;
+  g_line_hook = nullptr;
+}
+
+uint64_t now_ns() { return g_now; }
+
+void spend_ns(uint64_t ns) {
+  if (g_dispatching) { g_now += ns; return; }  // ISR/event body: no nested dispatch
+  run_until(g_now + ns, false);
+  check_deadline();
+}
+
+void spend_us(double us) { spend_ns((uint64_t)(us * 1000.0 + 0.5)); }
+
+void advance_to_ns(uint64_t t) {
+  if (t > g_now) spend_ns(t - g_now);
+}
+
+void wait_for_wake(uint64_t limit_ns) {
+  if (!g_irq_pending.empty()) return;  // WFI falls straight through on a pending IRQ
+  uint64_t tick = (g_now / 1000000ULL + 1) * 1000000ULL;
+  run_until(tick < limit_ns ? tick : limit_ns, true);
+  check_deadline();
+}
+
+bool step_event(uint64_t limit_ns) {
+  if (g_events.empty() || g_events.top().t > limit_ns) {
+    advance_to_ns(limit_ns);
+    return false;
+  }
+  run_until(g_events.top().t, false);
+  check_deadline();
+  return true;
+}
+
+void set_deadline_ns(uint64_t t) { g_deadline = t; }
+
+void at_ns(uint64_t t, Event fn, bool wake) {
+  g_events.push(Pending{ t, g_seq++, wake, std::move(fn) });
+}
+
+int pin_level(uint8_t pin) { return pin_ok(pin) ? g_level[pin] : LOW; }
+double pin_duty(uint8_t pin) { return pin_ok(pin) ? g_duty[pin] : 0.0; }
+
+void drive_pin(uint8_t pin, int level) {
+  if (!pin_ok(pin)) return;
+  level = level ? HIGH : LOW;
+  if (g_level[pin] == level) return;
+  g_level[pin] = level;
+  g_duty[pin] = level;
+  const Irq& irq = g_irq[pin];
+  if (!irq.fn) return;
+  bool edge = irq.mode == CHANGE || (irq.mode == RISING && level == HIGH) ||
+              (irq.mode == FALLING && level == LOW);
+  if (!edge) return;
+  if (g_irq_enabled) run_isr(irq.fn);
+  else g_irq_pending.push_back(irq.fn);
+}
+
+void on_pin_write(std::function<void(uint8_t, int)> fn) { g_pin_hook = std::move(fn); }
+void on_analog_write(std::function<void(uint8_t, int)> fn) { g_analog_write_hook = std::move(fn); }
+void on_analog_read(std::function<int(uint8_t, int)> fn) { g_analog_read_hook = std::move(fn); }
+void on_servo(std::function<void(uint8_t, int)> fn) { g_servo_hook = std::move(fn); }
+void on_serial_line(std::function<void(const std::string&)> fn) { g_line_hook = std::move(fn); }
+
+uint64_t serial_send(const std::string& bytes) {
+  uint64_t t = g_rx_last_ns > g_now ? g_rx_last_ns : g_now;
+  for (unsigned char c : bytes) {
+    t += byte_ns();
+    at_ns(t, [c] {
+      if (g_rx.size() >= g_costs.rx_buffer) { g_counters.rx_dropped++; return; }
+      g_rx.push_back(c);
+      g_counters.rx_bytes++;
+    }, true);
+  }
+  g_rx_last_ns = t;
+  return t;
+}
+
+void set_line_up(bool up) { g_line_up = up; }
+
+size_t serial_tx_backlog() {
+  if (g_tx_free_ns <= g_now) return 0;
+  return (size_t)((g_tx_free_ns - g_now + byte_ns() - 1) / byte_ns());
+}
+
+}  // namespace hal
+}  // namespace buggy
+
+using namespace buggy;
+
+// ---- Arduino core ----
+
+unsigned long millis() {
+  hal::spend_us(hal::costs().clock_read_us);
+  return (unsigned long)(hal::now_ns() / 1000000ULL);
+}
+
+unsigned long micros() {
+  hal::spend_us(hal::costs().clock_read_us);
+  return (unsigned long)(hal::now_ns() / 1000ULL);
+}
+
+void delay(unsigned long ms) { hal::spend_ns((uint64_t)ms * 1000000ULL); }
+void delayMicroseconds(unsigned int us) { hal::spend_ns((uint64_t)us * 1000ULL); }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  hal::spend_us(hal::costs().pin_mode_us);
+  if (mode == INPUT_PULLUP && hal::pin_ok(pin)) hal::g_level[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  hal::spend_us(hal::costs().digital_write_us);
+  hal::g_counters.digital_writes++;
+  if (!hal::pin_ok(pin)) return;
+  hal::g_level[pin] = val ? HIGH : LOW;
+  hal::g_duty[pin] = val ? 1.0 : 0.0;
+  if (hal::g_pin_hook) hal::g_pin_hook(pin, hal::g_level[pin]);
+}
+
+int digitalRead(uint8_t pin) {
+  hal::spend_us(hal::costs().digital_read_us);
+  return hal::pin_level(pin);
+}
+
+int analogRead(uint8_t pin) {
+  hal::spend_us(hal::costs().analog_read_us);
+  hal::g_counters.analog_reads++;
+  return hal::g_analog_read_hook ? hal::g_analog_read_hook(pin, hal::g_adc_bits) : 0;
+}
+
+void analogReadResolution(int bits) { hal::g_adc_bits = bits; }
+
+void analogWrite(uint8_t pin, int val) {
+  hal::spend_us(hal::costs().analog_write_us);
+  if (!hal::pin_ok(pin)) return;
+  val = constrain(val, 0, 255);
+  hal::g_duty[pin] = val / 255.0;
+  hal::g_level[pin] = val >= 128 ? HIGH : LOW;
+  if (hal::g_analog_write_hook) hal::g_analog_write_hook(pin, val);
+  if (hal::g_pin_hook) hal::g_pin_hook(pin, hal::g_level[pin]);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+  uint64_t deadline = hal::now_ns() + (uint64_t)timeout * 1000ULL;
+  int want = state ? HIGH : LOW;
+  while (hal::pin_level(pin) == want) { if (!hal::step_event(deadline)) return 0; }
+  while (hal::pin_level(pin) != want) { if (!hal::step_event(deadline)) return 0; }
+  uint64_t start = hal::now_ns();
+  while (hal::pin_level(pin) == want) { if (!hal::step_event(deadline)) return 0; }
+  return (unsigned long)((hal::now_ns() - start) / 1000ULL);
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
+  hal::g_counters.shift_outs++;
+  for (int i = 0; i < 8; i++) {
+    int bit = bitOrder == LSBFIRST ? (val >> i) & 1 : (val >> (7 - i)) & 1;
+    digitalWrite(dataPin, bit);
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+int digitalPinToInterrupt(uint8_t pin) { return hal::pin_ok(pin) ? pin : NOT_AN_INTERRUPT; }
+
+void attachInterrupt(int irq, void (*fn)(), int mode) {
+  if (irq < 0 || irq >= HAL_NUM_PINS) return;
+  hal::g_irq[irq].fn = fn;
+  hal::g_irq[irq].mode = mode;
+}
+
+void detachInterrupt(int irq) {
+  if (irq >= 0 && irq < HAL_NUM_PINS) hal::g_irq[irq] = hal::Irq();
+}
+
+void noInterrupts() { hal::g_irq_enabled = false; }
+
+void interrupts() {
+  hal::g_irq_enabled = true;
+  while (!hal::g_irq_pending.empty()) {
+    void (*fn)() = hal::g_irq_pending.front();
+    hal::g_irq_pending.erase(hal::g_irq_pending.begin());
+    hal::run_isr(fn);
+  }
+}
+
+void host_wait_for_interrupt() { hal::wait_for_wake(UINT64_MAX); }
+
+// ---- Print / Serial ----
+
+size_t Print::write(const uint8_t* buf, size_t n) {
+  for (size_t i = 0; i < n; i++) write(buf[i]);
+  return n;
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 10 && n < 0) return print('-') + print((unsigned long)(-(n + 1)) + 1UL, 10);
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    unsigned long d = n % (unsigned long)base;
+    n /= (unsigned long)base;
+    *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+  } while (n);
+  return write(p);
+}
+
+size_t Print::print(double n, int digits) {
+  if (isnan(n)) return write("nan");
+  if (isinf(n)) return write("inf");
+  if (n > 4294967040.0 || n < -4294967040.0) return write("ovf");
+  size_t out = 0;
+  if (n < 0.0) { out += print('-'); n = -n; }
+  double rounding = 0.5;
+  for (int i = 0; i < digits; i++) rounding /= 10.0;
+  n += rounding;
+  unsigned long whole = (unsigned long)n;
+  double rest = n - (double)whole;
+  out += print(whole);
+  if (digits > 0) out += print('.');
+  while (digits-- > 0) {
+    rest *= 10.0;
+    unsigned d = (unsigned)rest;
+    out += print((char)('0' + d));
+    rest -= d;
+  }
+  return out;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  while (available() <= 0) {
+    if (millis() - start >= timeout_ms_) return -1;
+    host_wait_for_interrupt();
+  }
+  return read();
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  for (int c = timedRead(); c >= 0 && c != terminator; c = timedRead()) out += (char)c;
+  return out;
+}
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) { hal::g_costs.baud = (uint32_t)baud; }
+
+int HardwareSerial::available() { return (int)hal::g_rx.size(); }
+
+int HardwareSerial::read() {
+  hal::spend_us(hal::costs().serial_get_us);
+  if (hal::g_rx.empty()) return -1;
+  int c = hal::g_rx.front();
+  hal::g_rx.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() { return hal::g_rx.empty() ? -1 : hal::g_rx.front(); }
+
+int HardwareSerial::availableForWrite() {
+  size_t used = hal::serial_tx_backlog();
+  return used >= hal::g_costs.tx_buffer ? 0 : (int)(hal::g_costs.tx_buffer - used);
+}
+
+void HardwareSerial::flush() { hal::advance_to_ns(hal::g_tx_free_ns); }
+
+size_t HardwareSerial::write(uint8_t c) {
+  hal::spend_us(hal::costs().serial_put_us);
+  uint64_t bn = hal::byte_ns();
+  uint64_t cap = hal::g_costs.tx_buffer * bn;
+  if (hal::g_tx_free_ns > hal::g_now && hal::g_tx_free_ns - hal::g_now >= cap) {
+    uint64_t wait = hal::g_tx_free_ns - hal::g_now - cap + bn;
+    hal::g_counters.tx_stall_ns += wait;
+    hal::spend_ns(wait);
+  }
+  if (hal::g_tx_free_ns < hal::g_now) hal::g_tx_free_ns = hal::g_now;
+  hal::g_tx_free_ns += bn;
+  hal::g_counters.tx_bytes++;
+  if (c == '\n') {
+    std::string line;
+    line.swap(hal::g_tx_line);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    hal::at_ns(hal::g_tx_free_ns, [line] { if (hal::g_line_hook) hal::g_line_hook(line); });
+  } else {
+    hal::g_tx_line += (char)c;
+  }
+  return 1;
+}
+
+HardwareSerial::operator bool() const { return hal::g_line_up; }
+
+// ---- Servo ----
+
+uint8_t Servo::attach(int pin, int min_us, int max_us) {
+  pin_ = pin;
+  min_us_ = min_us;
+  max_us_ = max_us;
+  return 1;
+}
+
+void Servo::detach() { pin_ = -1; }
+
+void Servo::write(int value) {
+  if (value < 200) value = min_us_ + (int)((long)constrain(value, 0, 180) * (max_us_ - min_us_) / 180);
+  writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int us) {
+  hal::spend_us(hal::costs().servo_write_us);
+  us_ = constrain(us, min_us_, max_us_);
+  if (pin_ >= 0 && hal::g_servo_hook) hal::g_servo_hook((uint8_t)pin_, us_);
+}
+
+int Servo::read() { return (int)((long)(us_ - min_us_) * 180 / (max_us_ - min_us_)); }
@@ -0,0 +1,85 @@
+#pragma once
+// Host side of the Arduino HAL: virtual clock, event queue, pin/serial/servo
+// hooks for a simulator, and the per-call cost model that drives the clock.
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace buggy {
+namespace hal {
+
+// Modelled duration of each core call on the UNO R4 (RA4M1, 48 MHz)
+struct CostModel {
+  double digital_write_us = 1.2;
+  double digital_read_us = 0.8;
+  double pin_mode_us = 1.5;
+  double analog_read_us = 22.0;
+  double analog_write_us = 3.0;
+  double clock_read_us = 0.3;  // millis()/micros()
+  double serial_put_us = 0.6;  // one byte into the TX ring
+  double serial_get_us = 0.4;  // one byte out of the RX ring
+  double servo_write_us = 2.0;
+  double isr_entry_us = 1.5;
+  double loop_pass_us = 20.0;  // firmware arithmetic per loop() pass (charged by the runner)
+  uint32_t baud = 115200;
+  size_t tx_buffer = 512;
+  size_t rx_buffer = 512;
+};
+
+struct Counters {
+  uint64_t digital_writes = 0;
+  uint64_t shift_outs = 0;
+  uint64_t analog_reads = 0;
+  uint64_t isr_calls = 0;
+  uint64_t tx_bytes = 0;
+  uint64_t rx_bytes = 0;
+  uint64_t rx_dropped = 0;
+  uint64_t tx_stall_ns = 0;  // time print() spent blocked on a full TX ring
+};
+
+CostModel& costs();
+Counters& counters();
+
+// Back to t=0 with all pins low, queues empty and hooks cleared
+void reset();
+
+uint64_t now_ns();
+// Charge ns of CPU time; events falling inside it run in time order
+void spend_ns(uint64_t ns);
+void spend_us(double us);
+void advance_to_ns(uint64_t t);
+// Run events up to the next wake source (pin IRQ, RX byte, 1 ms tick) or limit
+void wait_for_wake(uint64_t limit_ns);
+// Run events up to the next one or limit; false if limit was reached first
+bool step_event(uint64_t limit_ns);
+
+// Once the clock passes t, blocking calls throw Deadline so a driver can cut
+// off a sketch that never returns from loop() (0 = no deadline)
+struct Deadline {};
+void set_deadline_ns(uint64_t t);
+
+using Event = std::function<void()>;
+// wake: the event would end a WFI (interrupt source)
+void at_ns(uint64_t t, Event fn, bool wake = false);
+
+// Pins: levels written by the sketch, or driven from outside for inputs
+int pin_level(uint8_t pin);
+double pin_duty(uint8_t pin);  // analogWrite duty (0..1); digital writes give 0 or 1
+void drive_pin(uint8_t pin, int level);  // runs an attached ISR on a matching edge
+
+void on_pin_write(std::function<void(uint8_t pin, int level)> fn);
+void on_analog_write(std::function<void(uint8_t pin, int value)> fn);
+void on_analog_read(std::function<int(uint8_t pin, int bits)> fn);
+void on_servo(std::function<void(uint8_t pin, int us)> fn);
+
+// Serial: host -> board bytes arrive paced at the baud rate; board -> host
+// lines are delivered when their last byte has left the UART
+// serial_send returns when the last byte lands in the RX buffer
+uint64_t serial_send(const std::string& bytes);
+void on_serial_line(std::function<void(const std::string& line)> fn);
+void set_line_up(bool up);  // what (bool)Serial reports
+size_t serial_tx_backlog();
+
+}  // namespace hal
+}  // namespace buggy
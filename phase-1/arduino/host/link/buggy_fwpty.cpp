@@ -0,0 +1,150 @@
+// buggy_fwpty: runs BuggyPhase1 (host build) on the simulated rig in real
+// time and exposes its serial port as a pseudo-terminal, so the Jetson app,
+// buggy_rtt or a terminal can talk to it like a board on /dev/ttyACM0.
+//
+//   buggy_fwpty [--map room] [--seed 1] [--link PATH]
+//
+// The slave path is printed on stdout (and symlinked to --link if given).
+// A pacing event every 100 us holds the virtual clock to the wall clock, also
+// inside blocking calls such as pulseIn, and feeds host bytes into the
+// sketch's RX buffer at 115200 baud from the moment they are read off the pty.
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "../hal/hal.hpp"
+#include "../sim/rig.hpp"
+
+void setup();
+void loop();
+
+using namespace buggy;
+
+namespace {
+
+constexpr uint64_t kPaceNs = 100000;
+
+volatile sig_atomic_t g_stop = 0;
+
+struct Options {
+  std::string map = "room";
+  uint32_t seed = 1;
+  std::string link;
+};
+
+Options parse_args(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    const char* v = argv[i + 1];
+    if (k == "--map") o.map = v;
+    else if (k == "--seed") o.seed = (uint32_t)std::strtoul(v, nullptr, 10);
+    else if (k == "--link") o.link = v;
+    else std::fprintf(stderr, "buggy_fwpty: ignoring %s\n", k.c_str());
+  }
+  return o;
+}
+
+// Master side, non-blocking; *slave_fd is held open so the master never sees
+// a hang-up between clients
+int open_pty(std::string* path, int* slave_fd) {
+  int m = posix_openpt(O_RDWR | O_NOCTTY);
+  if (m < 0 || grantpt(m) != 0 || unlockpt(m) != 0) return -1;
+  const char* name = ptsname(m);
+  if (!name) return -1;
+  *path = name;
+  *slave_fd = open(name, O_RDWR | O_NOCTTY);
+  if (*slave_fd < 0) return -1;
+  termios t;
+  if (tcgetattr(*slave_fd, &t) == 0) {
+    cfmakeraw(&t);
+    cfsetspeed(&t, B115200);
+    tcsetattr(*slave_fd, TCSANOW, &t);
+  }
+  fcntl(m, F_SETFL, fcntl(m, F_GETFL) | O_NONBLOCK);
+  return m;
+}
+
+// A full pty (nobody reading) drops the rest of the line, as USB CDC does
+// with the port closed; never stall the sketch's clock on it
+void write_line(int fd, const std::string& s) {
+  size_t off = 0;
+  while (off < s.size()) {
+    ssize_t n = write(fd, s.data() + off, s.size() - off);
+    if (n <= 0) return;
+    off += (size_t)n;
+  }
+}
+
+uint64_t wall_ns(std::chrono::steady_clock::time_point t0) {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+// Sleep until the wall clock catches up with the virtual one, then take
+// whatever the host wrote meanwhile. If the process was descheduled and the
+// virtual clock lags, the bytes still enter at their wall-clock arrival time,
+// so a lag can only lengthen a measured round trip, never shorten it.
+void pace(int master, std::chrono::steady_clock::time_point t0, uint64_t v0) {
+  uint64_t wall = wall_ns(t0);
+  uint64_t virt = hal::now_ns() - v0;
+  if (virt > wall) {
+    timespec ts = { (time_t)((virt - wall) / 1000000000ULL), (long)((virt - wall) % 1000000000ULL) };
+    nanosleep(&ts, nullptr);
+  }
+  char buf[256];
+  ssize_t n;
+  while ((n = read(master, buf, sizeof(buf))) > 0) {
+    std::string bytes(buf, (size_t)n);
+    uint64_t at = v0 + wall_ns(t0);
+    if (at <= hal::now_ns()) hal::serial_send(bytes);
+    else hal::at_ns(at, [bytes] { hal::serial_send(bytes); });
+  }
+  hal::at_ns(hal::now_ns() + kPaceNs, [=] { pace(master, t0, v0); });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o = parse_args(argc, argv);
+  sim::Map map;
+  if (!sim::make_map(o.map, o.seed, &map)) { std::fprintf(stderr, "buggy_fwpty: unknown map %s\n", o.map.c_str()); return 2; }
+
+  std::string path;
+  int slave = -1;
+  int master = open_pty(&path, &slave);
+  if (master < 0) { perror("buggy_fwpty: pty"); return 1; }
+  if (!o.link.empty()) {
+    unlink(o.link.c_str());
+    if (symlink(path.c_str(), o.link.c_str()) != 0) perror("buggy_fwpty: symlink");
+  }
+  std::printf("%s\n", o.link.empty() ? path.c_str() : o.link.c_str());
+  std::fflush(stdout);
+  signal(SIGINT, [](int) { g_stop = 1; });
+  signal(SIGTERM, [](int) { g_stop = 1; });
+
+  hal::reset();
+  sim::Rig rig(map, sim::RigParams(), o.seed);
+  rig.attach();
+  hal::on_serial_line([&](const std::string& line) { write_line(master, line + "\r\n"); });
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const uint64_t v0 = hal::now_ns();
+  hal::at_ns(v0, [=] { pace(master, t0, v0); });
+  setup();
+  while (!g_stop) {
+    loop();
+    hal::spend_us(hal::costs().loop_pass_us);
+  }
+  if (!o.link.empty()) unlink(o.link.c_str());
+  close(slave);
+  close(master);
+  return 0;
+}
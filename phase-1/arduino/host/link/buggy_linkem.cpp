@@ -0,0 +1,329 @@
+// buggy_linkem: runs BuggyPhase1 (host build) on the simulated rig with the
+// Jetson controller model at the other end of an impaired serial link, and
+// reports watchdog trips, the drive time they cost and the link latencies,
+// so HB_TIMEOUT_MS and hb_period_ms can be picked from data.
+//
+//   buggy_linkem [--up SPEC] [--down SPEC] [--spike P:MS] [--hb-timeout 400,600,900]
+//                [--hb-period 100,200] [--trials 8] [--seconds 60] [--map room]
+//                [--seed 1] [--jobs N]
+//
+// --up is Jetson -> board, --down board -> Jetson; SPEC is described in
+// impair.hpp, e.g. "delay=2,jitter=3,dist=pareto,stall=0.002:250". --spike
+// freezes the controller (a Jetson CPU spike: no HB, no commands) for MS with
+// probability P per loop pass. Every grid cell runs the same seeds, so cells
+// differ only in the swept setting. Times are virtual, from the HAL cost model.
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../hal/hal.hpp"
+#include "../sim/rig.hpp"
+#include "../tune/controller_model.hpp"
+#include "../tune/fw_tune.hpp"
+#include "impair.hpp"
+#include "latency_hist.hpp"
+
+void setup();
+void loop();
+
+using namespace buggy;
+using namespace buggy::link;
+
+namespace {
+
+constexpr uint64_t kMs = 1000000ULL;
+constexpr uint64_t kEpochMs = 1700000000000ULL;  // see trial.cpp
+
+struct Options {
+  ImpairParams up, down;
+  double spike_prob = 0.0;
+  double spike_ms = 0.0;
+  std::vector<int> hb_timeouts = { 600 };
+  std::vector<int> hb_periods = { 200 };
+  int trials = 8;
+  double seconds = 60.0;
+  std::string map = "room";
+  uint32_t seed = 1;
+  int jobs = 0;
+};
+
+std::vector<int> parse_list(const char* v) {
+  std::vector<int> out;
+  for (const char* p = v; *p;) {
+    int n = std::atoi(p);
+    if (n > 0) out.push_back(n);
+    const char* comma = std::strchr(p, ',');
+    if (!comma) break;
+    p = comma + 1;
+  }
+  return out;
+}
+
+bool parse_args(int argc, char** argv, Options* o) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    const char* v = argv[i + 1];
+    std::string err;
+    if (k == "--up" || k == "--down") {
+      if (!parse_impair(v, k == "--up" ? &o->up : &o->down, &err)) {
+        std::fprintf(stderr, "buggy_linkem: %s: %s\n", k.c_str(), err.c_str());
+        return false;
+      }
+    } else if (k == "--spike") {
+      const char* colon = std::strchr(v, ':');
+      o->spike_prob = std::atof(v);
+      o->spike_ms = colon ? std::atof(colon + 1) : 0.0;
+    } else if (k == "--hb-timeout") o->hb_timeouts = parse_list(v);
+    else if (k == "--hb-period") o->hb_periods = parse_list(v);
+    else if (k == "--trials") o->trials = std::max(1, std::atoi(v));
+    else if (k == "--seconds") o->seconds = std::max(1.0, std::atof(v));
+    else if (k == "--map") o->map = v;
+    else if (k == "--seed") o->seed = (uint32_t)std::strtoul(v, nullptr, 10);
+    else if (k == "--jobs") o->jobs = std::atoi(v);
+    else std::fprintf(stderr, "buggy_linkem: ignoring %s\n", k.c_str());
+  }
+  if (o->hb_timeouts.empty() || o->hb_periods.empty()) {
+    std::fprintf(stderr, "buggy_linkem: empty --hb-timeout or --hb-period list\n");
+    return false;
+  }
+  return true;
+}
+
+struct LinkResult {
+  int ok = 0;
+  double seconds = 0.0;
+  uint32_t wdg_trips = 0;     // REASON=WDG as the firmware printed it
+  double stopped_ms = 0.0;    // trip -> next motion command landing at the board
+  uint32_t fw_errors = 0;     // ERR,... lines (damaged or truncated commands)
+  uint32_t collisions = 0;
+  double forward_cm = 0.0;
+  uint64_t up_lines = 0, up_lost = 0, up_corrupt = 0;
+  uint64_t down_lines = 0, down_lost = 0, down_corrupt = 0;
+  uint64_t stalls = 0;
+  uint32_t spikes = 0;
+  LatencyHist hb_gap;  // between HBs landing at the board
+  LatencyHist cmd;     // motion command: controller send -> last byte in the board's RX buffer
+  LatencyHist rtt;     // PING sent -> DIST at the controller
+};
+
+bool is_motion(const std::string& cmd) {
+  return cmd != "HB" && cmd != "PING" && cmd.compare(0, 6, "SERVO,") != 0;
+}
+
+LinkResult run_link(const Options& o, int hb_timeout_ms, int hb_period_ms, uint32_t seed) {
+  LinkResult res;
+  sim::Map map;
+  if (!sim::make_map(o.map, seed, &map)) return res;
+
+  hal::reset();
+  g_fw_tune.hb_timeout_ms = hb_timeout_ms;
+  sim::Rig rig(map, sim::RigParams(), seed);
+  rig.attach();
+  // Separate streams so the two directions and the host never share draws
+  Impairment up(o.up, seed * 2654435761u + 1);
+  Impairment down(o.down, seed * 2654435761u + 2);
+  std::mt19937 host_rng(seed * 2654435761u + 3);
+
+  tune::ControllerParams cp;
+  cp.hb_period_ms = hb_period_ms;
+
+  uint64_t last_hb_ns = 0;
+  uint64_t trip_ns = 0;  // 0 = not stopped by the watchdog
+  std::deque<uint64_t> pings;  // send times of PINGs that reached the board intact
+  tune::ControllerModel* ctl_ptr = nullptr;
+
+  tune::ControllerModel ctl(cp, [&](const std::string& cmd) {
+    const uint64_t sent = hal::now_ns();
+    std::string bytes = cmd + "\n";
+    uint64_t at = 0;
+    if (!up.pass(sent, &bytes, &at)) return;
+    hal::at_ns(at, [&, cmd, bytes, sent] {
+      uint64_t landed = hal::serial_send(bytes);
+      bool intact = bytes == cmd + "\n";
+      hal::at_ns(landed, [&, cmd, intact, sent, landed] {
+        if (!intact) return;
+        if (cmd == "HB") {
+          if (last_hb_ns) res.hb_gap.add((landed - last_hb_ns) * 1e-3);
+          last_hb_ns = landed;
+        } else if (cmd == "PING") {
+          pings.push_back(sent);
+        } else if (is_motion(cmd)) {
+          res.cmd.add((landed - sent) * 1e-3);
+          if (trip_ns) { res.stopped_ms += (landed - trip_ns) * 1e-6; trip_ns = 0; }
+        }
+      });
+    });
+  });
+  ctl_ptr = &ctl;
+
+  hal::on_serial_line([&](const std::string& line) {
+    const uint64_t now = hal::now_ns();
+    if (line == "REASON=WDG") { res.wdg_trips++; if (!trip_ns) trip_ns = now; }
+    if (line.compare(0, 4, "ERR,") == 0) res.fw_errors++;
+    uint64_t sent = 0;
+    if (line.compare(0, 5, "DIST,") == 0 && !pings.empty()) { sent = pings.front(); pings.pop_front(); }
+    std::string bytes = line + "\n";
+    uint64_t at = 0;
+    if (!down.pass(now, &bytes, &at)) return;
+    hal::at_ns(at, [&, bytes, sent] {
+      std::string got = bytes.substr(0, bytes.find('\n'));
+      if (sent && got.compare(0, 5, "DIST,") == 0) res.rtt.add((hal::now_ns() - sent) * 1e-3);
+      ctl_ptr->on_line(got);
+    });
+  });
+
+  setup();
+  const uint64_t start = hal::now_ns();
+  const uint64_t end = start + (uint64_t)(o.seconds * 1e9);
+  const uint64_t ctl_period = (uint64_t)cp.loop_sleep_ms * kMs;
+  uint64_t next_ctl = start;
+  uint64_t frozen_until = 0;
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  while (hal::now_ns() < end) {
+    uint64_t now = hal::now_ns();
+    if (now >= next_ctl) {
+      next_ctl += ctl_period;
+      if (now >= frozen_until && u(host_rng) < o.spike_prob) {
+        frozen_until = now + (uint64_t)(o.spike_ms * kMs);
+        res.spikes++;
+      }
+      if (now >= frozen_until) ctl.tick(kEpochMs + now / kMs);
+    }
+    loop();
+    hal::spend_us(hal::costs().loop_pass_us);
+  }
+  if (trip_ns) res.stopped_ms += (hal::now_ns() - trip_ns) * 1e-6;
+
+  res.ok = 1;
+  res.seconds = (hal::now_ns() - start) * 1e-9;
+  res.collisions = rig.stats().collisions;
+  res.forward_cm = rig.stats().forward_cm - rig.stats().reverse_cm;
+  res.up_lines = up.stats().lines;
+  res.up_lost = up.stats().dropped;
+  res.up_corrupt = up.stats().corrupted;
+  res.down_lines = down.stats().lines;
+  res.down_lost = down.stats().dropped;
+  res.down_corrupt = down.stats().corrupted;
+  res.stalls = up.stats().stalls + down.stats().stalls;
+  return res;
+}
+
+struct Job {
+  int hb_timeout_ms, hb_period_ms;
+  uint32_t seed;
+};
+
+// One forked child per job (firmware state is global), at most jobs at a time
+std::vector<LinkResult> run_all(const Options& o, const std::vector<Job>& jobs) {
+  static_assert(std::is_trivially_copyable<LinkResult>::value, "result crosses a pipe");
+  std::vector<LinkResult> out(jobs.size());
+  int width = o.jobs > 0 ? o.jobs : std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+  std::map<pid_t, std::pair<size_t, int>> running;  // pid -> (job index, read fd)
+  size_t next = 0;
+  fflush(stdout);
+  fflush(stderr);
+  while (next < jobs.size() || !running.empty()) {
+    while (next < jobs.size() && (int)running.size() < width) {
+      int fds[2];
+      if (pipe(fds) != 0) { perror("pipe"); break; }
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        const Job& j = jobs[next];
+        LinkResult r = run_link(o, j.hb_timeout_ms, j.hb_period_ms, j.seed);
+        ssize_t n = write(fds[1], &r, sizeof(r));
+        _exit(n == (ssize_t)sizeof(r) ? 0 : 1);
+      }
+      close(fds[1]);
+      if (pid < 0) { perror("fork"); close(fds[0]); break; }
+      running[pid] = { next++, fds[0] };
+    }
+    if (running.empty()) break;
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    auto it = running.find(pid);
+    if (it == running.end()) continue;
+    // The child wrote before exiting and the result fits in one pipe buffer
+    LinkResult r;
+    if (read(it->second.second, &r, sizeof(r)) == (ssize_t)sizeof(r)) out[it->second.first] = r;
+    close(it->second.second);
+    running.erase(it);
+  }
+  return out;
+}
+
+std::string ms(double us, const char* fmt = "%.1f") {
+  if (std::isnan(us)) return "n/a";
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), fmt, us * 1e-3);
+  return buf;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (!parse_args(argc, argv, &o)) return 2;
+  sim::Map probe;
+  if (!sim::make_map(o.map, o.seed, &probe)) { std::fprintf(stderr, "buggy_linkem: unknown map %s\n", o.map.c_str()); return 2; }
+
+  std::vector<Job> jobs;
+  for (int to : o.hb_timeouts)
+    for (int hb : o.hb_periods)
+      for (int t = 0; t < o.trials; t++) jobs.push_back({ to, hb, o.seed + (uint32_t)t });
+  std::vector<LinkResult> results = run_all(o, jobs);
+
+  std::printf("buggy_linkem: %d x %.0f s per cell, map %s (virtual time)\n", o.trials, o.seconds, o.map.c_str());
+  std::printf("  up   %s\n  down %s\n  host spike p=%g for %g ms per loop pass\n\n", describe(o.up).c_str(),
+              describe(o.down).c_str(), o.spike_prob, o.spike_ms);
+  std::printf("%6s %5s %6s %8s %8s %8s %8s %7s %7s %7s %7s %6s %6s %6s %5s\n", "hb_to", "hb", "trips", "trip/min",
+              "stop%", "gap99", "gap99.9", "gapmax", "cmd50", "cmd99", "rtt99", "lost", "corr", "err", "coll");
+
+  for (size_t first = 0; first < jobs.size(); first += o.trials) {
+    LinkResult sum;
+    int ok = 0;
+    double secs = 0.0;
+    for (size_t i = first; i < first + o.trials; i++) {
+      const LinkResult& r = results[i];
+      if (!r.ok) continue;
+      ok++;
+      secs += r.seconds;
+      sum.wdg_trips += r.wdg_trips;
+      sum.stopped_ms += r.stopped_ms;
+      sum.fw_errors += r.fw_errors;
+      sum.collisions += r.collisions;
+      sum.up_lost += r.up_lost;
+      sum.down_lost += r.down_lost;
+      sum.up_corrupt += r.up_corrupt;
+      sum.down_corrupt += r.down_corrupt;
+      sum.hb_gap.merge(r.hb_gap);
+      sum.cmd.merge(r.cmd);
+      sum.rtt.merge(r.rtt);
+    }
+    const Job& j = jobs[first];
+    if (!ok) { std::printf("%6d %5d  (all trials failed)\n", j.hb_timeout_ms, j.hb_period_ms); continue; }
+    std::printf("%6d %5d %6u %8.2f %8.2f %8s %8s %7s %7s %7s %7s %6llu %6llu %6u %5u\n", j.hb_timeout_ms, j.hb_period_ms,
+                sum.wdg_trips, sum.wdg_trips * 60.0 / secs, 100.0 * sum.stopped_ms / (secs * 1e3),
+                ms(sum.hb_gap.quantile_us(0.99)).c_str(), ms(sum.hb_gap.quantile_us(0.999)).c_str(),
+                ms(sum.hb_gap.n ? sum.hb_gap.max_us : NAN).c_str(), ms(sum.cmd.quantile_us(0.5)).c_str(),
+                ms(sum.cmd.quantile_us(0.99)).c_str(), ms(sum.rtt.quantile_us(0.99)).c_str(),
+                (unsigned long long)(sum.up_lost + sum.down_lost),
+                (unsigned long long)(sum.up_corrupt + sum.down_corrupt), sum.fw_errors, sum.collisions);
+  }
+  std::printf("\nhb_to/hb: HB_TIMEOUT_MS and hb_period_ms (ms). stop%%: share of the run stopped by a watchdog trip\n"
+              "until the next motion command landed. gap*: HB spacing at the board (ms). cmd*: motion command\n"
+              "send -> last byte at the board (ms). rtt99: PING -> DIST at the controller (ms). lost/corr: lines\n"
+              "dropped/damaged in either direction. err: ERR lines from the firmware. coll: wall contacts.\n");
+  return 0;
+}
@@ -0,0 +1,246 @@
+// buggy_rtt: round-trip latency of the Jetson <-> Arduino link, measured
+// from the host with a microsecond clock. Works on the real board or on a
+// host build behind buggy_fwpty.
+//
+//   buggy_rtt --port /dev/ttyACM0 [--probe ping|stat|mix] [--rate 0] [--window 1]
+//             [--count 2000] [--seconds 0] [--timeout 1000] [--hb 200] [--settle 2500]
+//
+// Probes are PING (answered by DIST,...) and Q (answered by STAT mode=...).
+// --window probes may be outstanding at once; --rate caps the send rate in
+// probes/s (0 = send as soon as the window allows). Replies are matched to
+// probes in order, per kind, so keep VERBOSE off while measuring. HB is sent
+// every --hb ms so the firmware watchdog stays quiet. Opening the real board
+// resets it; --settle waits out the boot before the first probe.
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "latency_hist.hpp"
+
+using namespace buggy::link;
+
+namespace {
+
+struct Options {
+  std::string port;
+  std::string probe = "ping";
+  double rate = 0.0;
+  int window = 1;
+  long count = 2000;
+  double seconds = 0.0;  // > 0: run for this long instead of --count probes
+  int timeout_ms = 1000;
+  int hb_ms = 200;
+  int settle_ms = 2500;
+};
+
+Options parse_args(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    const char* v = argv[i + 1];
+    if (k == "--port") o.port = v;
+    else if (k == "--probe") o.probe = v;
+    else if (k == "--rate") o.rate = std::max(0.0, std::atof(v));
+    else if (k == "--window") o.window = std::max(1, std::atoi(v));
+    else if (k == "--count") o.count = std::max(1L, std::atol(v));
+    else if (k == "--seconds") o.seconds = std::max(0.0, std::atof(v));
+    else if (k == "--timeout") o.timeout_ms = std::max(1, std::atoi(v));
+    else if (k == "--hb") o.hb_ms = std::max(0, std::atoi(v));
+    else if (k == "--settle") o.settle_ms = std::max(0, std::atoi(v));
+    else std::fprintf(stderr, "buggy_rtt: ignoring %s\n", k.c_str());
+  }
+  return o;
+}
+
+uint64_t now_us() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int open_port(const std::string& path) {
+  int fd = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) return -1;
+  termios t;
+  if (tcgetattr(fd, &t) == 0) {
+    cfmakeraw(&t);
+    cfsetspeed(&t, B115200);
+    t.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &t);
+  }
+  return fd;
+}
+
+bool send_line(int fd, const std::string& s) {
+  std::string line = s + "\n";
+  size_t off = 0;
+  while (off < line.size()) {
+    ssize_t n = write(fd, line.data() + off, line.size() - off);
+    if (n > 0) { off += (size_t)n; continue; }
+    pollfd p = { fd, POLLOUT, 0 };
+    if (poll(&p, 1, 1000) <= 0) return false;
+  }
+  return true;
+}
+
+enum Kind { kPing = 0, kStat = 1, kKinds };
+// Q answers with printStat()'s "STAT mode=..." line, which nothing else
+// prints; the periodic and STAT? snapshots use the "STAT,<mode>,..." form
+const char* const kProbeCmd[kKinds] = { "PING", "Q" };
+const char* const kReplyPrefix[kKinds] = { "DIST,", "STAT mode=" };
+const char* const kKindName[kKinds] = { "PING->DIST", "Q->STAT" };
+
+struct KindStats {
+  LatencyHist rtt;
+  long sent = 0;
+  long lost = 0;  // no reply within --timeout
+  std::deque<uint64_t> outstanding;  // send times, oldest first
+};
+
+std::string ms(double us) {
+  if (std::isnan(us)) return "n/a";
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.3f", us * 1e-3);
+  return buf;
+}
+
+// Percentiles plus a coarse log histogram (10 bins per decade)
+void report(const char* name, const KindStats& k, double secs) {
+  const LatencyHist& h = k.rtt;
+  std::printf("%s: sent %ld, answered %llu, lost %ld, %.1f replies/s\n", name, k.sent, (unsigned long long)h.n,
+              k.lost, secs > 0 ? h.n / secs : 0.0);
+  if (!h.n) return;
+  std::printf("  rtt ms  p50 %s  p90 %s  p99 %s  p99.9 %s  max %s  mean %s\n", ms(h.quantile_us(0.5)).c_str(),
+              ms(h.quantile_us(0.9)).c_str(), ms(h.quantile_us(0.99)).c_str(), ms(h.quantile_us(0.999)).c_str(),
+              ms(h.max_us).c_str(), ms(h.mean_us()).c_str());
+  constexpr int kGroup = LatencyHist::kPerDecade / 10;
+  uint32_t peak = 0;
+  int first = -1, last = -1;
+  for (int g = 0; g * kGroup < LatencyHist::kBins; g++) {
+    uint32_t c = 0;
+    for (int b = g * kGroup; b < std::min((g + 1) * kGroup, LatencyHist::kBins); b++) c += h.bins[b];
+    if (!c) continue;
+    peak = std::max(peak, c);
+    if (first < 0) first = g;
+    last = g;
+  }
+  uint64_t cum = 0;
+  for (int g = first; g <= last; g++) {
+    uint32_t c = 0;
+    for (int b = g * kGroup; b < std::min((g + 1) * kGroup, LatencyHist::kBins); b++) c += h.bins[b];
+    cum += c;
+    double lo = std::pow(10.0, (double)g * kGroup / LatencyHist::kPerDecade) * 1e-3;
+    double hi = std::pow(10.0, (double)(g + 1) * kGroup / LatencyHist::kPerDecade) * 1e-3;
+    int bar = peak ? (int)std::lround(40.0 * c / peak) : 0;
+    std::printf("  %9.3f-%-9.3f %7u %6.2f%% %s\n", lo, hi, c, 100.0 * cum / h.n, std::string(bar, '#').c_str());
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o = parse_args(argc, argv);
+  if (o.port.empty()) { std::fprintf(stderr, "buggy_rtt: --port is required\n"); return 2; }
+  if (o.probe != "ping" && o.probe != "stat" && o.probe != "mix") {
+    std::fprintf(stderr, "buggy_rtt: --probe must be ping, stat or mix\n");
+    return 2;
+  }
+  int fd = open_port(o.port);
+  if (fd < 0) { perror(("buggy_rtt: " + o.port).c_str()); return 1; }
+
+  std::string rx;
+  char buf[512];
+  auto drain_for = [&](int ms_) {
+    uint64_t until = now_us() + (uint64_t)ms_ * 1000;
+    while (now_us() < until) {
+      pollfd p = { fd, POLLIN, 0 };
+      poll(&p, 1, 20);
+      while (read(fd, buf, sizeof(buf)) > 0) {}
+    }
+  };
+  drain_for(o.settle_ms);
+  send_line(fd, "HB");
+  drain_for(50);
+
+  KindStats kinds[kKinds];
+  const uint64_t start = now_us();
+  const uint64_t end = o.seconds > 0 ? start + (uint64_t)(o.seconds * 1e6) : UINT64_MAX;
+  const uint64_t gap_us = o.rate > 0 ? (uint64_t)(1e6 / o.rate) : 0;
+  const uint64_t timeout_us = (uint64_t)o.timeout_ms * 1000;
+  uint64_t next_send = start, last_hb = start;
+  long sent = 0;
+  int next_kind = o.probe == "stat" ? kStat : kPing;
+  uint64_t last_reply = start;
+
+  auto in_flight = [&] { return (int)(kinds[kPing].outstanding.size() + kinds[kStat].outstanding.size()); };
+  auto done_sending = [&] { return o.seconds > 0 ? now_us() >= end : sent >= o.count; };
+
+  while (!done_sending() || in_flight() > 0) {
+    uint64_t now = now_us();
+    if (o.hb_ms && now - last_hb >= (uint64_t)o.hb_ms * 1000) {
+      send_line(fd, "HB");
+      last_hb = now;
+    }
+    if (!done_sending() && in_flight() < o.window && now >= next_send) {
+      KindStats& k = kinds[next_kind];
+      uint64_t t = now_us();
+      if (!send_line(fd, kProbeCmd[next_kind])) { std::fprintf(stderr, "buggy_rtt: write stalled\n"); break; }
+      k.outstanding.push_back(t);
+      k.sent++;
+      sent++;
+      if (o.probe == "mix") next_kind = 1 - next_kind;
+      next_send = gap_us ? std::max(next_send + gap_us, t) : t;
+      continue;
+    }
+
+    // Wait for bytes until the next send, HB or timeout check is due
+    uint64_t wake = now + 5000;
+    if (!done_sending() && in_flight() < o.window) wake = std::min(wake, next_send);
+    if (o.hb_ms) wake = std::min(wake, last_hb + (uint64_t)o.hb_ms * 1000);
+    pollfd p = { fd, POLLIN, 0 };
+    int wait_ms = wake > now ? (int)((wake - now + 999) / 1000) : 0;
+    poll(&p, 1, wait_ms);
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+      uint64_t t = now_us();  // stamp on arrival, before parsing
+      rx.append(buf, (size_t)n);
+      size_t nl;
+      while ((nl = rx.find('\n')) != std::string::npos) {
+        std::string line = rx.substr(0, nl);
+        rx.erase(0, nl + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        for (int i = 0; i < kKinds; i++) {
+          KindStats& k = kinds[i];
+          if (line.compare(0, std::strlen(kReplyPrefix[i]), kReplyPrefix[i]) != 0 || k.outstanding.empty()) continue;
+          k.rtt.add((double)(t - k.outstanding.front()));
+          k.outstanding.pop_front();
+          last_reply = t;
+        }
+      }
+    }
+    now = now_us();
+    for (KindStats& k : kinds) {
+      while (!k.outstanding.empty() && now - k.outstanding.front() > timeout_us) {
+        k.outstanding.pop_front();
+        k.lost++;
+      }
+    }
+  }
+  double secs = (last_reply - start) * 1e-6;
+
+  std::printf("buggy_rtt: %s, probe %s, window %d, rate %s\n", o.port.c_str(), o.probe.c_str(), o.window,
+              o.rate > 0 ? (std::to_string((int)o.rate) + "/s").c_str() : "open");
+  for (int i = 0; i < kKinds; i++)
+    if (kinds[i].sent) report(kKindName[i], kinds[i], secs);
+  close(fd);
+  return 0;
+}
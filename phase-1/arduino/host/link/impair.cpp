@@ -0,0 +1,149 @@
+#include "impair.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace buggy {
+namespace link {
+namespace {
+
+constexpr double kParetoAlpha = 1.5;
+constexpr double kJitterCapMs = 10000.0;
+
+bool parse_num(const std::string& s, double* out) {
+  char* end = nullptr;
+  *out = std::strtod(s.c_str(), &end);
+  return !s.empty() && *end == '\0' && *out >= 0.0;
+}
+
+// "a:b[:c]" into up to n numbers; returns how many were given
+int parse_tuple(const std::string& s, double* out, int n) {
+  int got = 0;
+  size_t pos = 0;
+  while (got < n) {
+    size_t colon = s.find(':', pos);
+    if (!parse_num(s.substr(pos, colon - pos), &out[got])) return -1;
+    got++;
+    if (colon == std::string::npos) return got;
+    pos = colon + 1;
+  }
+  return -1;
+}
+
+const char* dist_name(Jitter d) {
+  switch (d) {
+    case Jitter::kUniform: return "uniform";
+    case Jitter::kPareto: return "pareto";
+    default: return "exp";
+  }
+}
+
+}  // namespace
+
+bool parse_impair(const std::string& spec, ImpairParams* out, std::string* err) {
+  ImpairParams p;
+  size_t pos = 0;
+  while (pos < spec.size()) {
+    size_t comma = spec.find(',', pos);
+    std::string kv = spec.substr(pos, comma - pos);
+    pos = comma == std::string::npos ? spec.size() : comma + 1;
+    size_t eq = kv.find('=');
+    std::string k = kv.substr(0, eq);
+    std::string v = eq == std::string::npos ? "" : kv.substr(eq + 1);
+    double t[3];
+    bool ok = true;
+    if (k == "delay") ok = parse_num(v, &p.delay_ms);
+    else if (k == "jitter") ok = parse_num(v, &p.jitter_ms);
+    else if (k == "dist") {
+      if (v == "exp") p.dist = Jitter::kExp;
+      else if (v == "uniform") p.dist = Jitter::kUniform;
+      else if (v == "pareto") p.dist = Jitter::kPareto;
+      else ok = false;
+    } else if (k == "stall") {
+      ok = parse_tuple(v, t, 2) == 2 && t[0] <= 1.0;
+      if (ok) { p.stall_prob = t[0]; p.stall_ms = t[1]; }
+    } else if (k == "burst") {
+      int n = parse_tuple(v, t, 3);
+      ok = n >= 2 && t[0] <= 1.0 && t[1] <= 1.0 && (n < 3 || t[2] <= 1.0);
+      if (ok) { p.burst_enter = t[0]; p.burst_exit = t[1]; if (n == 3) p.burst_loss = t[2]; }
+    } else if (k == "corrupt") {
+      ok = parse_num(v, &p.corrupt_byte) && p.corrupt_byte <= 1.0;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      if (err) *err = "bad impairment '" + kv + "'";
+      return false;
+    }
+  }
+  *out = p;
+  return true;
+}
+
+std::string describe(const ImpairParams& p) {
+  char buf[200];
+  std::snprintf(buf, sizeof(buf), "delay=%g jitter=%g(%s) stall=%g:%g burst=%g:%g:%g corrupt=%g", p.delay_ms,
+                p.jitter_ms, dist_name(p.dist), p.stall_prob, p.stall_ms, p.burst_enter, p.burst_exit, p.burst_loss,
+                p.corrupt_byte);
+  return buf;
+}
+
+Impairment::Impairment(const ImpairParams& p, uint32_t seed) : p_(p), rng_(seed) {}
+
+double Impairment::jitter_ms() {
+  if (p_.jitter_ms <= 0.0) return 0.0;
+  double u = u_(rng_);
+  double j;
+  switch (p_.dist) {
+    case Jitter::kUniform: j = 2.0 * p_.jitter_ms * u; break;
+    case Jitter::kPareto: {
+      // Shifted so the minimum is 0 and the mean is jitter_ms
+      double xm = p_.jitter_ms * (kParetoAlpha - 1.0);
+      j = xm / std::pow(1.0 - u, 1.0 / kParetoAlpha) - xm;
+      break;
+    }
+    default: j = -p_.jitter_ms * std::log(1.0 - u); break;
+  }
+  return std::min(j, kJitterCapMs);
+}
+
+bool Impairment::pass(uint64_t t_ns, std::string* bytes, uint64_t* deliver_ns) {
+  stats_.lines++;
+
+  if (burst_) {
+    if (u_(rng_) < p_.burst_exit) burst_ = false;
+  } else if (u_(rng_) < p_.burst_enter) {
+    burst_ = true;
+  }
+  if (burst_ && u_(rng_) < p_.burst_loss) {
+    stats_.dropped++;
+    return false;
+  }
+
+  if (t_ns >= stall_until_ns_ && u_(rng_) < p_.stall_prob) {
+    stall_until_ns_ = t_ns + (uint64_t)(p_.stall_ms * 1e6);
+    stats_.stalls++;
+  }
+
+  if (p_.corrupt_byte > 0.0) {
+    bool hit = false;
+    for (char& c : *bytes) {
+      if (u_(rng_) >= p_.corrupt_byte) continue;
+      c = (char)(c ^ (1 << (rng_() % 8)));
+      hit = true;
+    }
+    if (hit) stats_.corrupted++;
+  }
+
+  uint64_t out = t_ns + (uint64_t)((p_.delay_ms + jitter_ms()) * 1e6);
+  out = std::max(out, stall_until_ns_);
+  out = std::max(out, last_out_ns_);
+  last_out_ns_ = out;
+  *deliver_ns = out;
+  return true;
+}
+
+}  // namespace link
+}  // namespace buggy
@@ -0,0 +1,64 @@
+#pragma once
+// One direction of an impaired serial link: latency with a jitter
+// distribution, link stalls (USB hiccups), Gilbert-Elliott burst line loss
+// and bit-flip corruption. Lines stay in order, as on a USB CDC port, and a
+// given seed always produces the same impairments for the same traffic.
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace buggy {
+namespace link {
+
+enum class Jitter { kExp, kUniform, kPareto };
+
+struct ImpairParams {
+  double delay_ms = 0.0;         // fixed one-way latency
+  double jitter_ms = 0.0;        // mean of the random part
+  Jitter dist = Jitter::kExp;    // pareto: heavy tail (alpha 1.5), like scheduler stalls
+  double stall_prob = 0.0;       // per line: the link freezes ...
+  double stall_ms = 0.0;         // ... for this long, then delivers the backlog at once
+  double burst_enter = 0.0;      // per line: good -> burst
+  double burst_exit = 0.5;       // per line: burst -> good
+  double burst_loss = 1.0;       // line loss while in a burst
+  double corrupt_byte = 0.0;     // per byte: one random bit flipped
+};
+
+// SPEC is comma-separated key=value pairs: delay=<ms> jitter=<ms>
+// dist=exp|uniform|pareto stall=<p>:<ms> burst=<enter>:<exit>[:<loss>]
+// corrupt=<p per byte>. An empty SPEC is a clean link.
+bool parse_impair(const std::string& spec, ImpairParams* out, std::string* err);
+std::string describe(const ImpairParams& p);
+
+struct ImpairStats {
+  uint64_t lines = 0;
+  uint64_t dropped = 0;
+  uint64_t corrupted = 0;  // lines with at least one flipped bit
+  uint64_t stalls = 0;
+};
+
+class Impairment {
+ public:
+  Impairment(const ImpairParams& p, uint32_t seed);
+
+  // Fate of one line (with its newline) handed to the link at t_ns. false:
+  // lost. Otherwise *bytes may have been corrupted and *deliver_ns is when
+  // it comes out, never before a line sent earlier.
+  bool pass(uint64_t t_ns, std::string* bytes, uint64_t* deliver_ns);
+
+  const ImpairStats& stats() const { return stats_; }
+
+ private:
+  double jitter_ms();
+
+  ImpairParams p_;
+  std::mt19937 rng_;
+  std::uniform_real_distribution<double> u_{0.0, 1.0};
+  bool burst_ = false;
+  uint64_t stall_until_ns_ = 0;
+  uint64_t last_out_ns_ = 0;
+  ImpairStats stats_;
+};
+
+}  // namespace link
+}  // namespace buggy
@@ -0,0 +1,53 @@
+#pragma once
+// Log-spaced latency histogram, 1 us .. 100 s at about 4.7 % per bin. Plain
+// data, so a forked trial can hand it back through a pipe.
+#include <cmath>
+#include <cstdint>
+
+namespace buggy {
+namespace link {
+
+struct LatencyHist {
+  static constexpr int kPerDecade = 50;
+  static constexpr int kBins = 8 * kPerDecade + 1;  // the last bin takes everything >= 100 s
+
+  uint32_t bins[kBins] = {};
+  uint64_t n = 0;
+  double sum_us = 0.0;
+  double max_us = 0.0;
+
+  void add(double us) {
+    int b = us < 1.0 ? 0 : (int)(std::log10(us) * kPerDecade);
+    bins[b < kBins ? b : kBins - 1]++;
+    n++;
+    sum_us += us;
+    if (us > max_us) max_us = us;
+  }
+
+  void merge(const LatencyHist& o) {
+    for (int b = 0; b < kBins; b++) bins[b] += o.bins[b];
+    n += o.n;
+    sum_us += o.sum_us;
+    if (o.max_us > max_us) max_us = o.max_us;
+  }
+
+  double mean_us() const { return n ? sum_us / n : NAN; }
+
+  // Geometric centre of the bin holding quantile q, never above the maximum
+  double quantile_us(double q) const {
+    if (!n) return NAN;
+    uint64_t rank = (uint64_t)std::ceil(q * n);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < kBins; b++) {
+      seen += bins[b];
+      if (seen < rank) continue;
+      double mid = std::pow(10.0, (b + 0.5) / kPerDecade);
+      return mid < max_us ? mid : max_us;
+    }
+    return max_us;
+  }
+};
+
+}  // namespace link
+}  // namespace buggy
@@ -0,0 +1,142 @@
+#include "rig.hpp"
+
+#include <cmath>
+
+#include "../hal/hal.hpp"
+
+namespace buggy {
+namespace sim {
+namespace {
+
+constexpr uint64_t kPhysicsNs = 1000000ULL;  // 1 ms
+constexpr double kDeg = M_PI / 180.0;
+constexpr double kEchoUsPerCm = 58.3;       // round trip at 343 m/s
+constexpr uint64_t kBurstNs = 460000ULL;    // trigger to ECHO rise (8-cycle burst)
+constexpr uint64_t kNoEchoNs = 38000000ULL;  // ECHO held high when nothing returns
+
+}  // namespace
+
+Rig::Rig(const Map& map, const RigParams& params, uint32_t seed)
+    : map_(map), p_(params), rng_(seed), pose_(map.start) {}
+
+void Rig::attach() {
+  const Wiring& w = p_.wiring;
+  hal::on_pin_write([this](uint8_t pin, int level) { on_pin(pin, level); });
+  hal::on_servo([this, w](uint8_t pin, int us) {
+    if (pin == w.servo) servo_cmd_ = (us - 544) * 180.0 / (2400 - 544);
+  });
+  hal::on_analog_read([this, w](uint8_t pin, int bits) -> int {
+    if (pin != w.batt) return 0;
+    double pack = p_.pack_mv - p_.sag_mv_per_motor * active_motors();
+    double counts = pack / 3.0 / 5000.0 * ((1 << bits) - 1);
+    return (int)std::lround(std::fmax(0.0, std::fmin(counts, (double)((1 << bits) - 1))));
+  });
+  hal::at_ns(hal::now_ns() + kPhysicsNs, [this] { physics(); });
+}
+
+int Rig::wheel_dir(int m) const {
+  const Wiring& w = p_.wiring;
+  bool a = (latch_out_ >> w.bit_a[m]) & 1, b = (latch_out_ >> w.bit_b[m]) & 1;
+  int raw = (a && !b) ? +1 : (!a && b) ? -1 : 0;
+  return w.rev[m] ? -raw : raw;
+}
+
+int Rig::active_motors() const {
+  if (hal::pin_duty(p_.wiring.sr_oe) >= 1.0) return 0;
+  int n = 0;
+  for (int m = 0; m < 4; m++) n += wheel_dir(m) != 0;
+  return n;
+}
+
+void Rig::on_pin(uint8_t pin, int level) {
+  const Wiring& w = p_.wiring;
+  if (pin == w.sr_clk) {
+    if (level && !clk_) shift_ = (uint8_t)((shift_ << 1) | (hal::pin_level(w.sr_data) & 1));
+    clk_ = level;
+  } else if (pin == w.sr_latch) {
+    if (!level && latch_pin_) latch_open_ns_ = hal::now_ns();
+    if (level && !latch_pin_) {
+      latch_out_ = shift_;
+      if (latch_fn_) latch_fn_(latch_out_, latch_open_ns_);
+    }
+    latch_pin_ = level;
+  } else if (pin == w.trig) {
+    uint64_t now = hal::now_ns();
+    if (level && !trig_) trig_rise_ns_ = now;
+    // HC-SR04 needs a >=10 us trigger and ignores it while still ranging
+    if (!level && trig_ && now - trig_rise_ns_ >= 8000ULL && now >= echo_busy_until_) fire_ping();
+    trig_ = level;
+  }
+}
+
+void Rig::fire_ping() {
+  stats_.pings++;
+  if (ping_fn_) ping_fn_();
+  double sx = pose_.x + p_.sensor_fwd_cm * std::cos(pose_.th);
+  double sy = pose_.y + p_.sensor_fwd_cm * std::sin(pose_.th);
+  double beam = pose_.th + (servo_deg_ - 90.0) * kDeg;
+  double min_cos = std::cos(p_.max_inc_deg * kDeg);
+  double best = INFINITY;
+  for (int i = 0; i < p_.beam_rays; i++) {
+    double off = p_.beam_rays > 1 ? -p_.beam_half_deg + i * 2.0 * p_.beam_half_deg / (p_.beam_rays - 1) : 0.0;
+    Hit h;
+    if (raycast(map_, sx, sy, beam + off * kDeg, p_.range_max_cm, &h) && h.cos_inc >= min_cos)
+      best = std::fmin(best, h.dist);
+  }
+  uint64_t rise = hal::now_ns() + kBurstNs;
+  uint64_t width = kNoEchoNs;
+  if (std::isfinite(best)) {
+    std::normal_distribution<double> noise(0.0, p_.noise_cm + 0.005 * best);
+    double cm = std::fmax(2.0, best + noise(rng_));
+    if (std::uniform_real_distribution<double>(0, 1)(rng_) < p_.ghost_prob)
+      cm *= std::uniform_real_distribution<double>(0.2, 0.6)(rng_);
+    width = (uint64_t)(cm * kEchoUsPerCm * 1000.0);
+  }
+  uint8_t echo = p_.wiring.echo;
+  hal::at_ns(rise, [echo] { hal::drive_pin(echo, 1); }, true);
+  hal::at_ns(rise + width, [echo] { hal::drive_pin(echo, 0); }, true);
+  echo_busy_until_ = rise + width;
+}
+
+void Rig::physics() {
+  const double dt = kPhysicsNs * 1e-9;
+  hal::at_ns(hal::now_ns() + kPhysicsNs, [this] { physics(); });
+
+  double step = p_.servo_dps * dt;
+  double err = servo_cmd_ - servo_deg_;
+  servo_deg_ += std::fabs(err) <= step ? err : std::copysign(step, err);
+
+  double enable = 1.0 - hal::pin_duty(p_.wiring.sr_oe);  // OE is active-LOW
+  double pack = p_.pack_mv - p_.sag_mv_per_motor * active_motors();
+  double vmax = p_.v_max_cms * enable * pack / p_.ref_mv;
+  double target[2] = { (wheel_dir(0) + wheel_dir(1)) * 0.5 * vmax,
+                       (wheel_dir(2) + wheel_dir(3)) * 0.5 * vmax };
+  for (int s = 0; s < 2; s++) v_side_[s] += (target[s] - v_side_[s]) * dt / p_.tau_s;
+
+  double v = 0.5 * (v_side_[0] + v_side_[1]);
+  double w = (v_side_[1] - v_side_[0]) / p_.track_cm * p_.turn_slip;
+  double th = pose_.th + w * dt;
+  double dx = v * std::cos(th) * dt, dy = v * std::sin(th) * dt;
+  pose_.th = std::remainder(th, 2.0 * M_PI);
+  double nx = 0.0, ny = 0.0;
+  if (clearance(map_, pose_.x + dx, pose_.y + dy) < p_.radius_cm) {
+    if (!in_contact_) stats_.collisions++;
+    in_contact_ = true;
+    // Scrape along the obstacle: keep only the motion tangent to it
+    clearance(map_, pose_.x, pose_.y, &nx, &ny);
+    double into = dx * nx + dy * ny;
+    if (into < 0.0) { dx -= into * nx; dy -= into * ny; }
+    if (clearance(map_, pose_.x + dx, pose_.y + dy) < p_.radius_cm) return;
+  } else if (clearance(map_, pose_.x + dx, pose_.y + dy) > p_.radius_cm + 1.0) {
+    in_contact_ = false;
+  }
+  double x = pose_.x + dx, y = pose_.y + dy;
+  v = std::copysign(std::hypot(dx, dy) / dt, v);
+  pose_.x = x;
+  pose_.y = y;
+  if (v >= 0) stats_.forward_cm += v * dt;
+  else stats_.reverse_cm -= v * dt;
+}
+
+}  // namespace sim
+}  // namespace buggy
@@ -0,0 +1,98 @@
+#pragma once
+// The buggy as the sketch sees it: 74HC595 + L293D shield decoded from pin
+// activity, skid-steer chassis, servo horn, HC-SR04 echo timing and the
+// pack voltage divider, all bound to the HAL's virtual clock.
+#include <cstdint>
+#include <functional>
+#include <random>
+
+#include "world.hpp"
+
+namespace buggy {
+namespace sim {
+
+// Mirrors BuggyPhase1/pins.h (Adafruit v1 motor shield)
+struct Wiring {
+  uint8_t sr_data = 8, sr_clk = 4, sr_latch = 12, sr_oe = 7;
+  uint8_t trig = 14, echo = 15;  // A0, A1
+  uint8_t servo = 10;
+  uint8_t batt = 17;            // A3 through 20k/10k
+  uint8_t bit_a[4] = { 2, 1, 5, 0 };
+  uint8_t bit_b[4] = { 3, 4, 7, 6 };
+  bool rev[4] = { false, true, false, true };  // M1 FL, M2 RL, M3 RR, M4 FR
+};
+
+// buggy_tune --rig overrides any of these; --turn-rates prints the drive
+// modes' turn rates to hold against jetson/scripts/measure_turn_rate.py
+struct RigParams {
+  // Wheel surface speed at 6.4 V, full duty. Fitted so a 500 ms B,SLOW
+  // backoff covers the ~20 cm phase_1_completion_notes.md reports
+  double v_max_cms = 40.0;
+  double ref_mv = 6400.0;
+  double tau_s = 0.12;          // wheel speed lag
+  double track_cm = 15.0;
+  double turn_slip = 0.5;       // skid-steer yaw efficiency
+  double radius_cm = 12.0;      // chassis bounding circle
+  double sensor_fwd_cm = 9.0;   // HC-SR04 ahead of the centre
+  double beam_half_deg = 15.0;
+  int beam_rays = 7;
+  double max_inc_deg = 55.0;    // steeper surfaces reflect the burst away
+  double range_max_cm = 400.0;
+  double noise_cm = 0.5;
+  double ghost_prob = 0.01;     // late multipath echo on a ping
+  double servo_dps = 450.0;
+  double pack_mv = 7400.0;
+  double sag_mv_per_motor = 120.0;
+  Wiring wiring;
+};
+
+struct RigStats {
+  double forward_cm = 0.0;
+  double reverse_cm = 0.0;
+  uint32_t collisions = 0;  // wall contacts (a sustained push counts once)
+  uint32_t pings = 0;
+};
+
+class Rig {
+ public:
+  Rig(const Map& map, const RigParams& params, uint32_t seed);
+  // Install HAL hooks and the 1 ms physics tick; call after hal::reset()
+  void attach();
+
+  const Pose& pose() const { return pose_; }
+  double servo_deg() const { return servo_deg_; }
+  uint8_t latch() const { return latch_out_; }
+  int wheel_dir(int motor) const;  // -1/0/+1 after REV, before OE
+  const RigStats& stats() const { return stats_; }
+
+  // Observers for benchmarks: each 74HC595 latch commit (with the time LATCH
+  // went low before it) and each ping the sensor accepts
+  void on_latch(std::function<void(uint8_t value, uint64_t open_ns)> fn) { latch_fn_ = std::move(fn); }
+  void on_ping(std::function<void()> fn) { ping_fn_ = std::move(fn); }
+
+ private:
+  void on_pin(uint8_t pin, int level);
+  void physics();
+  void fire_ping();
+  int active_motors() const;
+
+  Map map_;
+  RigParams p_;
+  std::mt19937 rng_;
+  Pose pose_;
+  RigStats stats_;
+  double v_side_[2] = { 0.0, 0.0 };
+  bool in_contact_ = false;
+  uint8_t shift_ = 0, latch_out_ = 0;
+  int clk_ = 0, latch_pin_ = 0;
+  uint64_t latch_open_ns_ = 0;
+  std::function<void(uint8_t, uint64_t)> latch_fn_;
+  std::function<void()> ping_fn_;
+  double servo_deg_ = 90.0, servo_cmd_ = 90.0;
+  uint64_t trig_rise_ns_ = 0;
+  int trig_ = 0;
+  uint64_t echo_busy_until_ = 0;
+};
+
+}  // namespace sim
+}  // namespace buggy
@@ -0,0 +1,134 @@
+#include "world.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace buggy {
+namespace sim {
+namespace {
+
+void add_box(Map* m, double x0, double y0, double x1, double y1) {
+  m->walls.push_back({ x0, y0, x1, y0 });
+  m->walls.push_back({ x1, y0, x1, y1 });
+  m->walls.push_back({ x1, y1, x0, y1 });
+  m->walls.push_back({ x0, y1, x0, y0 });
+}
+
+// Scatter n square obstacles inside [x0,x1]x[y0,y1], keeping keep_cm clear
+// of the start pose so every run begins with room to move
+void scatter(Map* m, std::mt19937& rng, int n, double x0, double y0, double x1, double y1,
+             double min_side, double max_side, double keep_cm) {
+  std::uniform_real_distribution<double> side(min_side, max_side);
+  for (int placed = 0, tries = 0; placed < n && tries < 200; tries++) {
+    double s = side(rng);
+    std::uniform_real_distribution<double> ux(x0, x1 - s), uy(y0, y1 - s);
+    double bx = ux(rng), by = uy(rng);
+    double cx = bx + s / 2, cy = by + s / 2;
+    if (std::hypot(cx - m->start.x, cy - m->start.y) < keep_cm + s) continue;
+    add_box(m, bx, by, bx + s, by + s);
+    placed++;
+  }
+}
+
+void room(Map* m, std::mt19937& rng) {
+  add_box(m, 0, 0, 400, 300);
+  m->start = { 60, 150, 0.0 };
+  scatter(m, rng, 3, 140, 30, 370, 270, 30, 60, 50);
+}
+
+void corridor(Map* m, std::mt19937& rng) {
+  // Ring corridor 90 cm wide around a central block
+  add_box(m, 0, 0, 400, 400);
+  add_box(m, 90, 90, 310, 310);
+  m->start = { 45, 200, M_PI / 2 };
+  std::uniform_int_distribution<int> leg(0, 3);
+  std::uniform_real_distribution<double> along(40, 320), across(10, 55);
+  for (int i = 0; i < 2; i++) {
+    int l = leg(rng);
+    double a = along(rng), c = across(rng);
+    double x = 0, y = 0;
+    switch (l) {
+      case 0: x = c; y = a; break;         // left leg
+      case 1: x = a; y = 310 + c; break;   // top leg
+      case 2: x = 310 + c; y = a; break;   // right leg
+      default: x = a; y = c; break;        // bottom leg
+    }
+    if (std::hypot(x - m->start.x, y - m->start.y) < 80) continue;
+    add_box(m, x, y, x + 15, y + 15);
+  }
+}
+
+void clutter(Map* m, std::mt19937& rng) {
+  add_box(m, 0, 0, 500, 500);
+  m->start = { 250, 60, M_PI / 2 };
+  scatter(m, rng, 10, 20, 20, 480, 480, 15, 45, 60);
+}
+
+void doorways(Map* m, std::mt19937& rng) {
+  add_box(m, 0, 0, 600, 300);
+  std::uniform_real_distribution<double> door(60, 180);
+  double y = door(rng);
+  m->walls.push_back({ 300, 0, 300, y });
+  m->walls.push_back({ 300, y + 60, 300, 300 });
+  m->start = { 80, 150, 0.0 };
+  scatter(m, rng, 2, 380, 30, 570, 270, 25, 45, 0);
+}
+
+double cross(double ax, double ay, double bx, double by) { return ax * by - ay * bx; }
+
+}  // namespace
+
+const std::vector<std::string>& map_names() {
+  static const std::vector<std::string> names = { "room", "corridor", "clutter", "doorways" };
+  return names;
+}
+
+bool make_map(const std::string& name, uint32_t seed, Map* out) {
+  std::mt19937 rng(seed);
+  *out = Map();
+  out->name = name;
+  if (name == "room") room(out, rng);
+  else if (name == "corridor") corridor(out, rng);
+  else if (name == "clutter") clutter(out, rng);
+  else if (name == "doorways") doorways(out, rng);
+  else return false;
+  return true;
+}
+
+bool raycast(const Map& map, double x, double y, double th, double max_cm, Hit* out) {
+  double dx = std::cos(th), dy = std::sin(th);
+  bool found = false;
+  for (const Seg& s : map.walls) {
+    double ex = s.x1 - s.x0, ey = s.y1 - s.y0;
+    double den = cross(dx, dy, ex, ey);
+    if (std::fabs(den) < 1e-9) continue;
+    double px = s.x0 - x, py = s.y0 - y;
+    double t = cross(px, py, ex, ey) / den;
+    double u = cross(px, py, dx, dy) / den;
+    if (t < 0.0 || t > max_cm || u < 0.0 || u > 1.0) continue;
+    if (found && t >= out->dist) continue;
+    double len = std::hypot(ex, ey);
+    out->dist = t;
+    out->cos_inc = std::fabs(dx * -ey + dy * ex) / len;
+    found = true;
+  }
+  return found;
+}
+
+double clearance(const Map& map, double x, double y, double* nx, double* ny) {
+  double best = INFINITY, bx = 0.0, by = 0.0;
+  for (const Seg& s : map.walls) {
+    double ex = s.x1 - s.x0, ey = s.y1 - s.y0;
+    double l2 = ex * ex + ey * ey;
+    double u = l2 > 0 ? ((x - s.x0) * ex + (y - s.y0) * ey) / l2 : 0.0;
+    u = u < 0 ? 0 : (u > 1 ? 1 : u);
+    double px = s.x0 + u * ex, py = s.y0 + u * ey;
+    double d = std::hypot(x - px, y - py);
+    if (d < best) { best = d; bx = px; by = py; }
+  }
+  if (nx && ny && best > 0.0 && std::isfinite(best)) { *nx = (x - bx) / best; *ny = (y - by) / best; }
+  return best;
+}
+
+}  // namespace sim
+}  // namespace buggy
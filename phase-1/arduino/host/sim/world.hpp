@@ -0,0 +1,40 @@
+#pragma once
+// 2-D arenas for the host simulator: wall segments in cm, a start pose and
+// ray/clearance queries against them.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace buggy {
+namespace sim {
+
+struct Seg {
+  double x0, y0, x1, y1;
+};
+
+struct Pose {
+  double x = 0.0, y = 0.0;  // cm
+  double th = 0.0;         // rad, CCW from +x
+};
+
+struct Map {
+  std::string name;
+  std::vector<Seg> walls;
+  Pose start;
+};
+
+struct Hit {
+  double dist;    // cm along the ray
+  double cos_inc;  // cosine of the incidence angle (1 = head-on)
+};
+
+// Built-in arenas; the seed moves the clutter, never the outer walls
+const std::vector<std::string>& map_names();
+bool make_map(const std::string& name, uint32_t seed, Map* out);
+
+bool raycast(const Map& map, double x, double y, double th, double max_cm, Hit* out);
+// Distance to the nearest wall; (nx, ny) = unit vector from that wall to the point
+double clearance(const Map& map, double x, double y, double* nx = nullptr, double* ny = nullptr);
+
+}  // namespace sim
+}  // namespace buggy
@@ -0,0 +1,97 @@
+// Safety stop and follow stand-off driven from ranger_mock_set_source(): the
+// firmware built with RANGER_BACKEND=2 and no rig attached. Exit status is the
+// ctest verdict; run with "safety" or "follow".
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "hal.hpp"
+#include "motion.h"
+#include "ranger.h"
+
+using namespace buggy;
+
+void setup();
+void loop();
+
+static uint64_t g_t0 = 0;
+static float g_near_cm = 15.0f;
+static std::string g_fol; // last FOL line
+static bool g_safety_evt = false;
+
+// Obstacle at 80 cm for the first 2 s, then g_near_cm
+static float source(unsigned long us) { return us - (unsigned long)(g_t0 / 1000) < 2000000UL ? 80.0f : g_near_cm; }
+
+static void send_at(double s, const std::string& cmd) {
+  hal::at_ns(g_t0 + (uint64_t)(s * 1e9), [cmd] { hal::serial_send(cmd + "\n"); });
+}
+
+static void run_until(double s) {
+  while (hal::now_ns() < g_t0 + (uint64_t)(s * 1e9)) {
+    loop();
+    hal::spend_us(hal::costs().loop_pass_us);
+  }
+}
+
+static float fol_field(const char* key) {
+  size_t at = g_fol.find(std::string(" ") + key + "=");
+  return at == std::string::npos ? NAN : std::strtof(g_fol.c_str() + at + std::strlen(key) + 2, nullptr);
+}
+
+static int fail(const char* what) {
+  std::fprintf(stderr, "FAIL: %s\n", what);
+  return 1;
+}
+
+static int start() {
+  hal::reset();
+  hal::on_serial_line([](const std::string& l) {
+    if (l.rfind("FOL ", 0) == 0) g_fol = l;
+    if (l == "EVT stop=safety") g_safety_evt = true;
+  });
+  g_t0 = hal::now_ns();
+  ranger_mock_set_source(source);
+  for (int i = 0; i < 20; i++) send_at(0.3 + i * 0.2, "HB");
+  setup();
+  return 0;
+}
+
+// T25 stops a slow run when the mock range drops to 15 cm, and not before
+static int test_safety() {
+  start();
+  send_at(0.3, "T25");
+  send_at(0.5, "F,SLOW");
+  run_until(1.9);
+  if (motion_get_mode() == MODE_STOP) return fail("stopped while the path was clear");
+  if (g_safety_evt) return fail("safety event at 80 cm");
+  run_until(2.5);
+  if (!g_safety_evt) return fail("no EVT stop=safety at 15 cm");
+  if (motion_get_mode() != MODE_STOP) return fail("still moving after the safety stop");
+  return 0;
+}
+
+// FOLLOW,ON,40 on a dead-ahead target closes the gap at 80 cm and holds at 30
+static int test_follow() {
+  g_near_cm = 30.0f;
+  start();
+  send_at(0.3, "FOLLOW,ON,40");
+  for (int i = 0; i < 60; i++) send_at(0.3 + i * 0.05, "VT,0,NA,0");
+  send_at(1.9, "FOLLOW?");
+  send_at(2.9, "FOLLOW?");
+  run_until(1.95);
+  if (fol_field("cm") != 80.0f) return fail("follow not ranging from the mock at 80 cm");
+  if (!(fol_field("fwd") > 0.0f)) return fail("no forward drive 40 cm short of the target");
+  run_until(2.95);
+  if (fol_field("cm") != 30.0f) return fail("follow not ranging from the mock at 30 cm");
+  if (fol_field("fwd") != 0.0f) return fail("forward drive inside the stand-off distance");
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  const char* which = argc > 1 ? argv[1] : "";
+  if (std::strcmp(which, "safety") == 0) return test_safety();
+  if (std::strcmp(which, "follow") == 0) return test_follow();
+  std::fprintf(stderr, "usage: %s safety|follow\n", argv[0]);
+  return 2;
+}
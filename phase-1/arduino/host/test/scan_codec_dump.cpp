@@ -0,0 +1,71 @@
+// SCB frames from the firmware encoder for the Python decoder to check
+// (jetson/tests/test_scan_codec.py). One JSON object per line: the SCB line as
+// scan_emit_binary() printed it and the ScanFrame it was made from.
+#include <cstdio>
+#include <string>
+#include "hal.hpp"
+#include "config.h"
+#include "scan_codec.h"
+
+using namespace buggy;
+
+static std::string g_line;
+
+static void dump(const ScanFrame& f) {
+  g_line.clear();
+  scan_emit_binary(&f);
+  Serial.flush(); // the line hook fires as the last byte leaves
+  std::printf("{\"line\": \"%s\", \"seq\": %u, \"dir\": %d, \"t0_ms\": %lu, \"samples\": [", g_line.c_str(),
+              (unsigned)f.seq, (int)f.dir, (unsigned long)f.t0_ms);
+  for (uint8_t i = 0; i < f.n; i++) {
+    const ScanSample& s = f.s[i];
+    std::printf("%s[%d, %u, %u, %u]", i ? ", " : "", s.angle_cdeg, (unsigned)s.unc_cdeg, (unsigned)s.range_mm,
+                (unsigned)s.dt_ms);
+  }
+  std::printf("]}\n");
+}
+
+int main() {
+  hal::reset();
+  hal::on_serial_line([](const std::string& l) { if (l.rfind("SCB ", 0) == 0) g_line = l; });
+  Serial.begin(115200);
+  std::printf("{\"fit_cdeg\": %d}\n", SCB_ANGLE_FIT_CDEG);
+
+  // A regular pass: angle jitter inside the fit, a few missing echoes
+  ScanFrame f = {};
+  f.t0_ms = 123456;
+  f.seq = 7;
+  f.dir = 1;
+  f.n = 30;
+  for (uint8_t i = 0; i < f.n; i++) {
+    f.s[i].angle_cdeg = (int16_t)(3000 + 400 * i + (i % 3 == 0 ? 15 : -10));
+    f.s[i].unc_cdeg = (uint16_t)(50 + 7 * (i % 5));
+    f.s[i].range_mm = (i % 9 == 4) ? 0 : (uint16_t)(1800 - 37 * i);
+    f.s[i].dt_ms = (uint16_t)(21 * i + (i & 1));
+  }
+  dump(f);
+
+  // Leftward pass with irregular steps and large range jumps
+  f.seq = 65535;
+  f.dir = -1;
+  f.n = SCAN_MAX_SAMPLES;
+  int16_t a = 16500;
+  uint16_t t = 5;
+  for (uint8_t i = 0; i < f.n; i++) {
+    f.s[i].angle_cdeg = a;
+    f.s[i].unc_cdeg = (uint16_t)(i == 11 ? 900 : 120);
+    f.s[i].range_mm = (i % 4 == 1) ? 0 : (uint16_t)(i % 2 ? 4000 : 200 + i);
+    f.s[i].dt_ms = t;
+    a = (int16_t)(a - 350 - 97 * (i % 4));
+    t = (uint16_t)(t + 18 + 13 * (i % 3));
+  }
+  dump(f);
+
+  // One sample, nothing in range
+  f.seq = 0;
+  f.dir = 1;
+  f.n = 1;
+  f.s[0] = { -1200, 300, 0, 0 };
+  dump(f);
+  return 0;
+}
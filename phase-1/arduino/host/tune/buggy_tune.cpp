@@ -0,0 +1,394 @@
+// buggy_tune: searches controller and firmware knobs with sep-CMA-ES over
+// simulated runs of the real firmware (host build) driven by a port of the
+// Jetson controller. Maximises mean speed subject to zero collisions and a
+// bounded stop rate; writes a Jetson profile overlay and a firmware header.
+//
+//   buggy_tune [--maps room,corridor,clutter,doorways] [--seconds 45]
+//              [--generations 30] [--seeds 2] [--lambda 0] [--sigma 0.3]
+//              [--jobs <nproc>] [--max-stop-rate 6] [--seed 1]
+//              [--validate-seeds 3] [--profile-out <path>] [--header-out <path>]
+//              [--eval 1] [--trace <map>] [--turn-rates 1] [--rig <name>=<v>,...]
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../sim/world.hpp"
+#include "cmaes.hpp"
+#include "trial.hpp"
+
+using namespace buggy;
+using namespace buggy::tune;
+
+namespace {
+
+struct Options {
+  std::vector<std::string> maps = sim::map_names();
+  double seconds = 45.0;
+  int generations = 30;
+  int seeds = 2;            // arenas per map per generation (shared by all candidates)
+  int lambda = 0;           // 0 = 4 + 3 ln n
+  double sigma = 0.3;       // initial step, in units of each knob's range
+  int jobs = 0;             // 0 = all cores
+  double max_stop_rate = 6.0;  // safety stops + backoffs per minute
+  uint32_t seed = 1;
+  int validate_seeds = 3;
+  std::string profile_out = BUGGY_REPO_DIR "/phase-1/jetson/config/profiles/tuned.yaml";
+  std::string header_out = "tuned_config.h";
+  bool eval_only = false;
+  std::string trace;        // map name: run one traced trial with the defaults
+  bool turn_rates = false;  // print the rig's measure_turn_rate.py table
+  sim::RigParams rig;       // --rig overrides, to fit the sim to the real buggy
+  bool help = false;
+};
+
+void usage(FILE* f) {
+  std::fprintf(f,
+               "usage: buggy_tune [--maps room,corridor,clutter,doorways] [--seconds 45]\n"
+               "                  [--generations 30] [--seeds 2] [--lambda 0] [--sigma 0.3]\n"
+               "                  [--jobs <nproc>] [--max-stop-rate 6] [--seed 1]\n"
+               "                  [--validate-seeds 3] [--profile-out <path>] [--header-out <path>]\n"
+               "                  [--eval 1] [--trace <map>] [--turn-rates 1] [--rig <name>=<v>,...]\n");
+}
+
+// RigParams fields --rig may set
+const std::vector<std::pair<const char*, double sim::RigParams::*>>& rig_fields() {
+  static const std::vector<std::pair<const char*, double sim::RigParams::*>> f = {
+    { "v_max_cms", &sim::RigParams::v_max_cms },         { "tau_s", &sim::RigParams::tau_s },
+    { "track_cm", &sim::RigParams::track_cm },           { "turn_slip", &sim::RigParams::turn_slip },
+    { "radius_cm", &sim::RigParams::radius_cm },         { "sensor_fwd_cm", &sim::RigParams::sensor_fwd_cm },
+    { "beam_half_deg", &sim::RigParams::beam_half_deg }, { "max_inc_deg", &sim::RigParams::max_inc_deg },
+    { "noise_cm", &sim::RigParams::noise_cm },           { "ghost_prob", &sim::RigParams::ghost_prob },
+    { "servo_dps", &sim::RigParams::servo_dps },         { "pack_mv", &sim::RigParams::pack_mv },
+  };
+  return f;
+}
+
+std::vector<std::string> split(const std::string& s) {
+  std::vector<std::string> out;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ',')) if (!item.empty()) out.push_back(item);
+  return out;
+}
+
+Options parse_args(int argc, char** argv) {
+  Options o;
+  // A tuning run takes minutes; never start one on a bare or misspelt flag
+  for (int i = 1; i < argc; i++) {
+    std::string k = argv[i];
+    if (k == "--help" || k == "-h") { o.help = true; return o; }
+  }
+  if (argc % 2 == 0) {
+    std::fprintf(stderr, "buggy_tune: %s needs a value\n", argv[argc - 1]);
+    usage(stderr);
+    std::exit(2);
+  }
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    const char* v = argv[i + 1];
+    if (k == "--maps") o.maps = split(v);
+    else if (k == "--seconds") o.seconds = std::atof(v);
+    else if (k == "--generations") o.generations = std::atoi(v);
+    else if (k == "--seeds") o.seeds = std::max(1, std::atoi(v));
+    else if (k == "--lambda") o.lambda = std::atoi(v);
+    else if (k == "--sigma") o.sigma = std::atof(v);
+    else if (k == "--jobs") o.jobs = std::atoi(v);
+    else if (k == "--max-stop-rate") o.max_stop_rate = std::atof(v);
+    else if (k == "--seed") o.seed = (uint32_t)std::strtoul(v, nullptr, 10);
+    else if (k == "--validate-seeds") o.validate_seeds = std::max(1, std::atoi(v));
+    else if (k == "--profile-out") o.profile_out = v;
+    else if (k == "--header-out") o.header_out = v;
+    else if (k == "--eval") o.eval_only = std::atoi(v) != 0;
+    else if (k == "--trace") o.trace = v;
+    else if (k == "--turn-rates") o.turn_rates = std::atoi(v) != 0;
+    else if (k == "--rig") {
+      for (const std::string& kv : split(v)) {
+        size_t eq = kv.find('=');
+        std::string name = kv.substr(0, eq);
+        double sim::RigParams::*field = nullptr;
+        for (const auto& f : rig_fields()) if (name == f.first) field = f.second;
+        if (eq == std::string::npos || !field) {
+          std::fprintf(stderr, "buggy_tune: unknown rig parameter %s\n", kv.c_str());
+          std::exit(2);
+        }
+        o.rig.*field = std::atof(kv.c_str() + eq + 1);
+      }
+    }
+    else std::fprintf(stderr, "buggy_tune: ignoring %s\n", k.c_str());
+  }
+  if (o.jobs <= 0) o.jobs = (int)std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+  return o;
+}
+
+// One searched knob: [lo, hi] mapped from the optimiser's unit interval.
+// Exit thresholds are searched as gaps above their enter value so the
+// hysteresis can never invert.
+struct Knob {
+  const char* section;  // YAML section, or "firmware" for config.h
+  const char* key;
+  double lo, hi;
+  double def;           // shipped default (default.yaml / config.h)
+  void (*apply)(TrialSpec* s, int v);
+};
+
+const std::vector<Knob>& knobs() {
+  static const std::vector<Knob> k = {
+    { "thresholds_cm", "slow_enter", 30, 150, 60, [](TrialSpec* s, int v) { s->ctl.slow_enter = v; } },
+    { "thresholds_cm", "slow_exit", 5, 40, 15, [](TrialSpec* s, int v) { s->ctl.slow_exit = s->ctl.slow_enter + v; } },
+    { "thresholds_cm", "turn_enter", 20, 90, 35, [](TrialSpec* s, int v) { s->ctl.turn_enter = v; } },
+    { "thresholds_cm", "turn_exit", 5, 40, 10, [](TrialSpec* s, int v) { s->ctl.turn_exit = s->ctl.turn_enter + v; } },
+    { "thresholds_cm", "stop_enter", 8, 40, 20, [](TrialSpec* s, int v) { s->ctl.stop_enter = v; } },
+    { "thresholds_cm", "stop_exit", 5, 30, 10, [](TrialSpec* s, int v) { s->ctl.stop_exit = s->ctl.stop_enter + v; } },
+    { "cadence_ms", "rescan_ms", 80, 400, 200, [](TrialSpec* s, int v) { s->ctl.rescan_ms = v; } },
+    { "cadence_ms", "min_turn_ms", 150, 1500, 550, [](TrialSpec* s, int v) { s->ctl.min_turn_ms = v; } },
+    { "cadence_ms", "backoff_ms", 150, 1000, 500, [](TrialSpec* s, int v) { s->ctl.backoff_ms = v; } },
+    { "cadence_ms", "stall_timer_ms", 800, 5000, 2500, [](TrialSpec* s, int v) { s->ctl.stall_timer_ms = v; } },
+    { "cadence_ms", "meas_cooldown_ms", 10, 80, 40, [](TrialSpec* s, int v) { s->ctl.meas_cooldown_ms = v; } },
+    { "cadence_ms", "servo_settle_ms", 20, 200, 100, [](TrialSpec* s, int v) { s->ctl.servo_settle_ms = v; } },
+    { "sweep", "step_deg", 10, 45, 15, [](TrialSpec* s, int v) { s->ctl.step_deg = v; } },
+    { "sweep", "samples_per_point", 1, 4, 3, [](TrialSpec* s, int v) { s->ctl.samples_per_point = v; } },
+    { "firmware", "SLOW_PULSE_ON_MS", 10, 80, 40, [](TrialSpec* s, int v) { s->fw.slow_pulse_on_ms = v; } },
+    { "firmware", "SLOW_PULSE_OFF_MS", 5, 80, 15, [](TrialSpec* s, int v) { s->fw.slow_pulse_off_ms = v; } },
+    { "firmware", "SERVO_SETTLE_MS", 10, 120, 40, [](TrialSpec* s, int v) { s->fw.servo_settle_ms = v; } },
+    { "firmware", "SAFETY_DEFAULT_CM", 0, 30, 0, [](TrialSpec* s, int v) { s->fw.safety_default_cm = v; } },
+  };
+  return k;
+}
+
+int knob_value(const Knob& k, double u) { return (int)std::lround(k.lo + u * (k.hi - k.lo)); }
+
+std::vector<double> defaults_unit() {
+  std::vector<double> u;
+  for (const Knob& k : knobs()) u.push_back((k.def - k.lo) / (k.hi - k.lo));
+  return u;
+}
+
+TrialSpec spec_for(const std::vector<double>& u) {
+  TrialSpec s;
+  for (size_t i = 0; i < knobs().size(); i++) knobs()[i].apply(&s, knob_value(knobs()[i], u[i]));
+  return s;
+}
+
+// Aggregate of one candidate's trials
+struct Score {
+  double speed = 0.0;  // cm/s, mean over trials
+  double stops = 0.0;  // per minute, mean over trials
+  uint32_t collisions = 0;
+  uint32_t failed = 0;
+  double cost = 0.0;
+  bool feasible = false;
+};
+
+// Constraint-first ranking: any feasible candidate beats every infeasible one
+Score score(const TrialResult* r, size_t n, double max_stop_rate) {
+  Score s;
+  for (size_t i = 0; i < n; i++) {
+    if (!r[i].ok) { s.failed++; continue; }
+    s.speed += r[i].mean_speed_cms();
+    s.stops += r[i].stops_per_min();
+    s.collisions += r[i].collisions;
+  }
+  size_t good = n - s.failed;
+  if (good) { s.speed /= good; s.stops /= good; }
+  double excess = std::max(0.0, s.stops - max_stop_rate);
+  s.feasible = s.failed == 0 && s.collisions == 0 && excess == 0.0;
+  s.cost = s.feasible ? -s.speed : 1000.0 + 1000.0 * s.failed + 100.0 * s.collisions + 10.0 * excess - 0.01 * s.speed;
+  return s;
+}
+
+std::vector<TrialSpec> trials_for(const std::vector<double>& u, const Options& o, uint32_t seed0, int seeds) {
+  std::vector<TrialSpec> out;
+  for (const std::string& m : o.maps) {
+    for (int k = 0; k < seeds; k++) {
+      TrialSpec s = spec_for(u);
+      s.map = m;
+      s.seed = seed0 + (uint32_t)k;
+      s.seconds = o.seconds;
+      s.rig = o.rig;
+      out.push_back(s);
+    }
+  }
+  return out;
+}
+
+void print_score(const char* tag, const Score& s) {
+  std::printf("%-10s speed=%5.1f cm/s  collisions=%u  stops=%4.1f/min  cost=%8.2f%s\n", tag, s.speed,
+              s.collisions, s.stops, s.cost, s.failed ? "  (trials failed)" : "");
+}
+
+// Evaluate candidates on the same arenas; returns one score per candidate
+std::vector<Score> evaluate(const std::vector<std::vector<double>>& cands, const Options& o, uint32_t seed0,
+                            int seeds) {
+  std::vector<TrialSpec> all;
+  for (const auto& u : cands) {
+    std::vector<TrialSpec> t = trials_for(u, o, seed0, seeds);
+    all.insert(all.end(), t.begin(), t.end());
+  }
+  std::vector<TrialResult> res = run_parallel(all, o.jobs);
+  size_t per = o.maps.size() * (size_t)seeds;
+  std::vector<Score> out;
+  for (size_t c = 0; c < cands.size(); c++) out.push_back(score(&res[c * per], per, o.max_stop_rate));
+  return out;
+}
+
+bool write_profile(const Options& o, const std::vector<double>& u, const Score& tuned, const Score& base,
+                   int generations, int lambda) {
+  FILE* f = std::fopen(o.profile_out.c_str(), "w");
+  if (!f) { std::perror(o.profile_out.c_str()); return false; }
+  std::string maps;
+  for (const std::string& m : o.maps) maps += (maps.empty() ? "" : ",") + m;
+  std::fprintf(f, "# Tuned by buggy_tune (arduino/host): sep-CMA-ES, %d generations x %d candidates\n",
+               generations, lambda);
+  std::fprintf(f, "# over maps %s, %.0f s per trial. Validation on %d fresh arenas per map:\n", maps.c_str(),
+               o.seconds, o.validate_seeds);
+  std::fprintf(f, "#   mean speed %.1f cm/s (defaults %.1f), collisions %u, stops %.1f/min (bound %.1f)\n",
+               tuned.speed, base.speed, tuned.collisions, tuned.stops, o.max_stop_rate);
+  std::fprintf(f, "# Firmware knobs from the same run go in BuggyPhase1/tuned_config.h:\n");
+  const std::vector<Knob>& k = knobs();
+  for (size_t i = 0; i < k.size(); i++)
+    if (std::string(k[i].section) == "firmware") std::fprintf(f, "#   %s %d\n", k[i].key, knob_value(k[i], u[i]));
+
+  TrialSpec s = spec_for(u);
+  std::fprintf(f, "\nthresholds_cm:\n");
+  std::fprintf(f, "  slow_enter: %.0f\n  slow_exit: %.0f\n", s.ctl.slow_enter, s.ctl.slow_exit);
+  std::fprintf(f, "  turn_enter: %.0f\n  turn_exit: %.0f\n", s.ctl.turn_enter, s.ctl.turn_exit);
+  std::fprintf(f, "  stop_enter: %.0f\n  stop_exit: %.0f\n", s.ctl.stop_enter, s.ctl.stop_exit);
+  std::fprintf(f, "\ncadence_ms:\n");
+  std::fprintf(f, "  rescan_ms: %d\n  min_turn_ms: %d\n  backoff_ms: %d\n", s.ctl.rescan_ms, s.ctl.min_turn_ms,
+               s.ctl.backoff_ms);
+  std::fprintf(f, "  stall_timer_ms: %d\n  meas_cooldown_ms: %d\n  servo_settle_ms: %d\n", s.ctl.stall_timer_ms,
+               s.ctl.meas_cooldown_ms, s.ctl.servo_settle_ms);
+  std::fprintf(f, "\nsweep:\n  step_deg: %d\n  samples_per_point: %d\n", s.ctl.step_deg, s.ctl.samples_per_point);
+  std::fclose(f);
+  return true;
+}
+
+bool write_header(const Options& o, const std::vector<double>& u) {
+  FILE* f = std::fopen(o.header_out.c_str(), "w");
+  if (!f) { std::perror(o.header_out.c_str()); return false; }
+  std::fprintf(f, "#pragma once\n// Generated by buggy_tune alongside %s.\n", o.profile_out.c_str());
+  std::fprintf(f, "// Copy next to BuggyPhase1.ino; config.h includes it ahead of its defaults.\n");
+  const std::vector<Knob>& k = knobs();
+  for (size_t i = 0; i < k.size(); i++) {
+    if (std::string(k[i].section) != "firmware") continue;
+    std::fprintf(f, "#ifndef %s\n#define %s %d\n#endif\n", k[i].key, k[i].key, knob_value(k[i], u[i]));
+  }
+  std::fclose(f);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options o = parse_args(argc, argv);
+  if (o.help) { usage(stdout); return 0; }
+  for (const std::string& m : o.maps) {
+    sim::Map probe;
+    if (!sim::make_map(m, 1, &probe)) { std::fprintf(stderr, "buggy_tune: unknown map %s\n", m.c_str()); return 2; }
+  }
+  const uint32_t validate_seed = 1000000u + o.seed * 1000u;
+  std::vector<double> u0 = defaults_unit();
+
+  if (!o.trace.empty()) {
+    TrialSpec s = spec_for(u0);
+    s.map = o.trace;
+    s.seed = validate_seed;
+    s.seconds = o.seconds;
+    s.rig = o.rig;
+    s.trace = true;
+    TrialResult r = run_parallel({ s }, 1)[0];
+    std::printf("speed=%.1f cm/s collisions=%u safety_stops=%u backoffs=%u pings=%u\n", r.mean_speed_cms(),
+                r.collisions, r.safety_stops, r.backoffs, r.pings);
+    return r.ok ? 0 : 1;
+  }
+
+  if (o.turn_rates) {
+    // Same modes, suffix and timing as measure_turn_rate.py's defaults, plus
+    // the controller's arcs and its backoff burst, to compare against the
+    // real buggy and fit --rig to it
+    std::vector<TrialSpec> specs;
+    for (const char* m : { "SPINL", "SPINR", "PIVOTL", "PIVOTR", "FSPINL", "FSPINR", "RSPINL", "RSPINR", "XSPINL",
+                           "XSPINR" }) {
+      TrialSpec s = spec_for(u0);
+      s.burst = std::string(m) + "160";
+      specs.push_back(s);
+    }
+    for (const char* m : { "L,SLOW", "R,SLOW", "F,FAST", "B,SLOW" }) {
+      TrialSpec s = spec_for(u0);
+      s.burst = m;
+      if (s.burst == "B,SLOW") s.burst_ms = s.ctl.backoff_ms;
+      specs.push_back(s);
+    }
+    for (TrialSpec& s : specs) s.rig = o.rig;
+    std::vector<TrialResult> res = run_parallel(specs, o.jobs);
+    std::printf("mode      burst_ms    deg/s   moved_cm   (+ = CCW/left, %d ms settle)\n", specs[0].settle_ms);
+    for (size_t i = 0; i < specs.size(); i++)
+      std::printf("%-9s %8d %+8.0f %10.1f%s\n", specs[i].burst.c_str(), specs[i].burst_ms,
+                  res[i].turn_deg / (specs[i].burst_ms / 1000.0), res[i].travel_cm, res[i].ok ? "" : "  (failed)");
+    return 0;
+  }
+
+  if (o.eval_only) {
+    Score s = evaluate({ u0 }, o, validate_seed, o.validate_seeds)[0];
+    print_score("defaults", s);
+    return 0;
+  }
+
+  SepCmaEs es(u0, o.sigma, o.seed, o.lambda);
+  std::printf("buggy_tune: %zu knobs, lambda=%d, %zu maps x %d seeds, %.0f s trials, %d jobs\n", knobs().size(),
+              es.lambda(), o.maps.size(), o.seeds, o.seconds, o.jobs);
+
+  // Best feasible candidates seen during the search (re-checked on fresh arenas)
+  const size_t kKeep = 5;
+  std::vector<std::pair<double, std::vector<double>>> elite;
+  for (int g = 0; g < o.generations; g++) {
+    std::vector<std::vector<double>> cands = es.ask();
+    std::vector<Score> sc = evaluate(cands, o, o.seed * 100000u + (uint32_t)g * 100u, o.seeds);
+    std::vector<double> cost;
+    size_t best = 0;
+    for (size_t i = 0; i < sc.size(); i++) {
+      cost.push_back(sc[i].cost);
+      if (sc[i].cost < sc[best].cost) best = i;
+      if (sc[i].feasible) elite.push_back({ sc[i].cost, cands[i] });
+    }
+    std::sort(elite.begin(), elite.end(),
+              [](const std::pair<double, std::vector<double>>& a, const std::pair<double, std::vector<double>>& b) {
+                return a.first < b.first;
+              });
+    if (elite.size() > kKeep) elite.resize(kKeep);
+    es.tell(cost);
+    char tag[32];
+    std::snprintf(tag, sizeof tag, "gen %d", g + 1);
+    print_score(tag, sc[best]);
+    std::fflush(stdout);
+  }
+
+  // Validate defaults, the final mean and the elite on arenas the search never saw
+  std::vector<std::vector<double>> finalists = { u0, es.mean() };
+  for (const auto& e : elite) finalists.push_back(e.second);
+  std::vector<Score> val = evaluate(finalists, o, validate_seed, o.validate_seeds);
+  print_score("defaults", val[0]);
+  size_t pick = 0;
+  for (size_t i = 1; i < val.size(); i++) {
+    print_score(i == 1 ? "mean" : "elite", val[i]);
+    if (val[i].cost < val[pick].cost) pick = i;
+  }
+  if (pick == 0) {
+    std::printf("buggy_tune: nothing beat the defaults on validation; no profile written\n");
+    return 1;
+  }
+  if (!val[pick].feasible) {
+    std::printf("buggy_tune: best candidate still collides or exceeds --max-stop-rate; no profile written\n");
+    return 1;
+  }
+  bool ok = write_profile(o, finalists[pick], val[pick], val[0], o.generations, es.lambda()) &&
+            write_header(o, finalists[pick]);
+  if (ok) std::printf("wrote %s and %s\n", o.profile_out.c_str(), o.header_out.c_str());
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include "cmaes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace buggy {
+namespace tune {
+
+SepCmaEs::SepCmaEs(const std::vector<double>& x0, double sigma0, uint32_t seed, int lambda)
+    : n_((int)x0.size()), sigma_(sigma0), mean_(x0), diag_(x0.size(), 1.0),
+      ps_(x0.size(), 0.0), pc_(x0.size(), 0.0), rng_(seed) {
+  const double n = n_;
+  lambda_ = lambda > 0 ? lambda : 4 + (int)std::floor(3.0 * std::log(n));
+  mu_ = lambda_ / 2;
+  for (int i = 0; i < mu_; i++) w_.push_back(std::log(mu_ + 0.5) - std::log(i + 1.0));
+  double sw = std::accumulate(w_.begin(), w_.end(), 0.0);
+  double sw2 = 0.0;
+  for (double& w : w_) { w /= sw; sw2 += w * w; }
+  mueff_ = 1.0 / sw2;
+
+  cs_ = (mueff_ + 2.0) / (n + mueff_ + 5.0);
+  ds_ = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff_ - 1.0) / (n + 1.0)) - 1.0) + cs_;
+  cc_ = (4.0 + mueff_ / n) / (n + 4.0 + 2.0 * mueff_ / n);
+  // Diagonal-only learning rates scale up by (n+2)/3
+  c1_ = 2.0 / ((n + 1.3) * (n + 1.3) + mueff_) * (n + 2.0) / 3.0;
+  cmu_ = std::min(1.0 - c1_, 2.0 * (mueff_ - 2.0 + 1.0 / mueff_) / ((n + 2.0) * (n + 2.0) + mueff_) * (n + 2.0) / 3.0);
+  chin_ = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+}
+
+const std::vector<std::vector<double>>& SepCmaEs::ask() {
+  std::normal_distribution<double> N(0.0, 1.0);
+  z_.assign(lambda_, std::vector<double>(n_));
+  x_.assign(lambda_, std::vector<double>(n_));
+  for (int k = 0; k < lambda_; k++) {
+    for (int i = 0; i < n_; i++) {
+      z_[k][i] = N(rng_);
+      double x = mean_[i] + sigma_ * std::sqrt(diag_[i]) * z_[k][i];
+      // Resample-free boundary handling: mirror into [0,1], then clip
+      if (x < 0.0) x = -x;
+      if (x > 1.0) x = 2.0 - x;
+      x_[k][i] = std::min(1.0, std::max(0.0, x));
+    }
+  }
+  return x_;
+}
+
+void SepCmaEs::tell(const std::vector<double>& cost) {
+  std::vector<int> idx(lambda_);
+  std::iota(idx.begin(), idx.end(), 0);
+  std::sort(idx.begin(), idx.end(), [&](int a, int b) { return cost[a] < cost[b]; });
+
+  // Recombine in the space the samples were evaluated in (mirrored/clipped)
+  std::vector<double> old = mean_;
+  std::vector<double> yw(n_, 0.0), zw(n_, 0.0);
+  for (int r = 0; r < mu_; r++) {
+    const std::vector<double>& x = x_[idx[r]];
+    for (int i = 0; i < n_; i++) {
+      double y = (x[i] - old[i]) / sigma_;
+      yw[i] += w_[r] * y;
+      zw[i] += w_[r] * y / std::sqrt(diag_[i]);
+    }
+  }
+  for (int i = 0; i < n_; i++) mean_[i] = old[i] + sigma_ * yw[i];
+
+  double ps2 = 0.0;
+  for (int i = 0; i < n_; i++) {
+    ps_[i] = (1.0 - cs_) * ps_[i] + std::sqrt(cs_ * (2.0 - cs_) * mueff_) * zw[i];
+    ps2 += ps_[i] * ps_[i];
+  }
+  double psn = std::sqrt(ps2);
+  gen_++;
+  bool hs = psn / std::sqrt(1.0 - std::pow(1.0 - cs_, 2.0 * gen_)) < (1.4 + 2.0 / (n_ + 1.0)) * chin_;
+
+  for (int i = 0; i < n_; i++) {
+    pc_[i] = (1.0 - cc_) * pc_[i] + (hs ? std::sqrt(cc_ * (2.0 - cc_) * mueff_) : 0.0) * yw[i];
+    double rank_mu = 0.0;
+    for (int r = 0; r < mu_; r++) {
+      double y = (x_[idx[r]][i] - old[i]) / sigma_;
+      rank_mu += w_[r] * y * y;
+    }
+    double d = (1.0 - c1_ - cmu_) * diag_[i] + c1_ * (pc_[i] * pc_[i] + (hs ? 0.0 : cc_ * (2.0 - cc_) * diag_[i])) +
+               cmu_ * rank_mu;
+    diag_[i] = std::max(d, 1e-12);
+  }
+  sigma_ *= std::exp(cs_ / ds_ * (psn / chin_ - 1.0));
+  sigma_ = std::min(sigma_, 1.0);
+}
+
+}  // namespace tune
+}  // namespace buggy
@@ -0,0 +1,36 @@
+#pragma once
+// Separable (diagonal-covariance) CMA-ES, Ros & Hansen 2008. Minimises over
+// the unit box; callers map [0,1]^n onto their parameter ranges.
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace buggy {
+namespace tune {
+
+class SepCmaEs {
+ public:
+  SepCmaEs(const std::vector<double>& x0, double sigma0, uint32_t seed, int lambda = 0);
+
+  int lambda() const { return lambda_; }
+  int generation() const { return gen_; }
+  double sigma() const { return sigma_; }
+  const std::vector<double>& mean() const { return mean_; }
+
+  // Candidates for this generation, clipped to [0,1]
+  const std::vector<std::vector<double>>& ask();
+  // Costs for the candidates from ask(), same order
+  void tell(const std::vector<double>& cost);
+
+ private:
+  int n_, lambda_, mu_, gen_ = 0;
+  std::vector<double> w_;
+  double mueff_, cs_, ds_, cc_, c1_, cmu_, chin_;
+  double sigma_;
+  std::vector<double> mean_, diag_, ps_, pc_;
+  std::vector<std::vector<double>> z_, x_;
+  std::mt19937_64 rng_;
+};
+
+}  // namespace tune
+}  // namespace buggy
@@ -0,0 +1,203 @@
+#include "controller_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace buggy {
+namespace tune {
+namespace {
+
+double median(std::vector<double> v) {
+  if (v.empty()) return NAN;
+  std::sort(v.begin(), v.end());
+  size_t n = v.size();
+  return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+}  // namespace
+
+ControllerModel::ControllerModel(const ControllerParams& p, Send send)
+    : p_(p), send_(std::move(send)), dist_left_(NAN), dist_center_(NAN), dist_right_(NAN) {
+  center_deg_ = 90 + p_.center_trim_deg;
+  // sensing.py _build_angles_cycle: CENTER -> RIGHT -> CENTER -> LEFT -> CENTER
+  angles_.push_back(center_deg_);
+  if (center_deg_ - p_.step_deg >= p_.right_deg) angles_.push_back(center_deg_ - p_.step_deg);
+  angles_.push_back(center_deg_);
+  if (center_deg_ + p_.step_deg <= p_.left_deg) angles_.push_back(center_deg_ + p_.step_deg);
+  angles_.push_back(center_deg_);
+  current_servo_deg_ = center_deg_;
+  max_attempts_ = std::max(2, p_.samples_per_point * 2);
+}
+
+void ControllerModel::tick(uint64_t now_ms) {
+  if (now_ms - last_hb_ms_ >= (uint64_t)p_.hb_period_ms) {
+    send_("HB");
+    last_hb_ms_ = now_ms;
+  }
+  sensing_tick(now_ms);
+  sm_tick(now_ms);
+}
+
+// ---- sensing.py ----
+
+void ControllerModel::send_servo(int deg, uint64_t now) {
+  if (deg == current_servo_deg_ && servo_move_ms_ > 0) return;
+  send_("SERVO," + std::to_string(deg));
+  servo_move_ms_ = now;
+  awaiting_ping_ = false;
+  samples_.clear();
+  current_servo_deg_ = deg;
+  attempts_ = 0;
+}
+
+void ControllerModel::consume_lines() {
+  while (!lines_.empty()) {
+    std::string line = lines_.front();
+    lines_.pop_front();
+    if (line.compare(0, 5, "DIST,") != 0) continue;
+    std::string v = line.substr(5);
+    if (v != "NA") {
+      std::replace(v.begin(), v.end(), ',', '.');
+      char* end = nullptr;
+      double cm = std::strtod(v.c_str(), &end);
+      if (end != v.c_str()) samples_.push_back(cm);
+    }
+    awaiting_ping_ = false;
+  }
+}
+
+void ControllerModel::sensing_tick(uint64_t now) {
+  if (awaiting_ping_ && now - last_ping_ms_ >= (uint64_t)std::max(200, p_.meas_cooldown_ms * 3))
+    awaiting_ping_ = false;
+  if (now - last_scan_ms_ >= (uint64_t)p_.rescan_ms && !awaiting_ping_ && samples_.empty()) {
+    send_servo(angles_[cycle_index_], now);
+    last_scan_ms_ = now;
+    return;
+  }
+
+  if (servo_move_ms_ > 0 && now - servo_move_ms_ >= (uint64_t)p_.servo_settle_ms) {
+    if ((int)samples_.size() < p_.samples_per_point && !awaiting_ping_) {
+      if (attempts_ >= max_attempts_) {
+        int angle = angles_[cycle_index_];
+        if (angle == center_deg_) dist_center_ = NAN;
+        else if (angle == p_.left_deg) dist_left_ = NAN;
+        else if (angle == p_.right_deg) dist_right_ = NAN;
+        cycle_index_ = (cycle_index_ + 1) % angles_.size();
+        servo_move_ms_ = 0;
+        awaiting_ping_ = false;
+        samples_.clear();
+        attempts_ = 0;
+      } else if (samples_.empty() || now - last_ping_ms_ >= (uint64_t)p_.meas_cooldown_ms) {
+        send_("PING");
+        awaiting_ping_ = true;
+        last_ping_ms_ = now;
+        attempts_++;
+      }
+    }
+  }
+
+  consume_lines();
+
+  if ((int)samples_.size() >= p_.samples_per_point) {
+    double m = median(samples_);
+    int angle = angles_[cycle_index_];
+    if (angle == center_deg_) { dist_center_ = m; last_valid_center_ms_ = now; }
+    else if (angle == p_.left_deg) dist_left_ = m;
+    else if (angle == p_.right_deg) dist_right_ = m;
+    cycle_index_ = (cycle_index_ + 1) % angles_.size();
+    servo_move_ms_ = 0;
+    awaiting_ping_ = false;
+    samples_.clear();
+    attempts_ = 0;
+  }
+}
+
+// ---- controller.py ----
+
+void ControllerModel::send_once(const std::string& cmd) {
+  if (!cmd.empty() && cmd != last_cmd_) {
+    send_(cmd);
+    last_cmd_ = cmd;
+  }
+}
+
+void ControllerModel::enter_backoff(uint64_t now) {
+  state_ = "BACKOFF";
+  backoff_until_ms_ = now + p_.backoff_ms;
+  backoffs_++;
+}
+
+void ControllerModel::decide_action(double dl, double dc, double dr, uint64_t now, std::string* cmd,
+                                    std::string* decision) {
+  if (dc < p_.stop_enter && state_ != "BACKOFF") {
+    enter_backoff(now);
+    *cmd = "B,SLOW";
+    *decision = "BACKOFF";
+    return;
+  }
+  if ((state_ == "AVOID_ARC" || state_ == "AVOID_SPIN") && now < commit_until_ms_) {
+    *cmd = last_cmd_;
+    *decision = state_;
+    return;
+  }
+  if (dc < p_.turn_enter) {
+    state_ = "AVOID_ARC";
+    commit_until_ms_ = now + p_.min_turn_ms;
+    *cmd = dl > dr ? "L,SLOW" : "R,SLOW";
+    *decision = "AVOID_ARC";
+    return;
+  }
+  if (dc > p_.turn_exit) state_ = "CRUISE";
+  *cmd = "F," + speed_;
+  *decision = "CRUISE";
+}
+
+void ControllerModel::sm_tick(uint64_t now) {
+  double dl = std::isnan(dist_left_) ? 999.0 : dist_left_;
+  double dc = std::isnan(dist_center_) ? 999.0 : dist_center_;
+  double dr = std::isnan(dist_right_) ? 999.0 : dist_right_;
+
+  if (speed_ == "FAST" && dc < p_.slow_enter) speed_ = "SLOW";
+  else if (speed_ == "SLOW" && dc > p_.slow_exit) speed_ = "FAST";
+
+  std::string cmd, decision;
+  if (last_valid_center_ms_ == 0 || now - last_valid_center_ms_ > (uint64_t)p_.rescan_ms * 3) {
+    state_ = "SENSOR_RECOVERY";
+    cmd = "F,SLOW";
+    decision = "SENSOR_RECOVERY";
+  }
+
+  if (state_ == "BACKOFF" && cmd.empty()) {
+    if (now < backoff_until_ms_) {
+      cmd = "B,SLOW";
+      decision = "BACKOFF";
+    } else {
+      state_ = "AVOID_SPIN";
+      commit_until_ms_ = now + p_.min_turn_ms;
+      cmd = dl > dr ? "SPINL" : "SPINR";
+      decision = "AVOID_SPIN";
+    }
+  }
+
+  if (cmd.empty()) decide_action(dl, dc, dr, now, &cmd, &decision);
+
+  if (state_ != "BACKOFF") {
+    if (dc < p_.turn_exit) {
+      if (stall_start_ms_ == 0) {
+        stall_start_ms_ = now;
+      } else if (now - stall_start_ms_ > (uint64_t)p_.stall_timer_ms && now >= commit_until_ms_) {
+        enter_backoff(now);
+        cmd = "B,SLOW";
+        decision = "STALL_BACKOFF";
+      }
+    } else {
+      stall_start_ms_ = 0;
+    }
+  }
+
+  send_once(cmd);
+}
+
+}  // namespace tune
+}  // namespace buggy
@@ -0,0 +1,82 @@
+#pragma once
+// Line-for-line port of jetson/app (watchdog.py, sensing.py, controller.py)
+// so trials exercise the same decisions the Jetson makes, quirks included.
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace buggy {
+namespace tune {
+
+struct ControllerParams {
+  // thresholds_cm
+  double slow_enter = 60, slow_exit = 75;
+  double turn_enter = 35, turn_exit = 45;
+  double stop_enter = 20, stop_exit = 30;
+  // cadence_ms
+  int rescan_ms = 200;
+  int min_turn_ms = 550;
+  int backoff_ms = 500;
+  int stall_timer_ms = 2500;
+  int meas_cooldown_ms = 40;
+  int servo_settle_ms = 100;
+  // sweep
+  int left_deg = 135, right_deg = 45;
+  int step_deg = 15;
+  int center_trim_deg = 0;
+  int samples_per_point = 3;
+  // watchdog / main loop
+  int hb_period_ms = 200;
+  int loop_sleep_ms = 20;
+};
+
+class ControllerModel {
+ public:
+  using Send = std::function<void(const std::string& cmd)>;
+  ControllerModel(const ControllerParams& p, Send send);
+
+  void on_line(const std::string& line) { lines_.push_back(line); }
+  // One pass of main.py's loop: watchdog, sensing, state machine
+  void tick(uint64_t now_ms);
+
+  const std::string& state() const { return state_; }
+  uint32_t backoffs() const { return backoffs_; }
+
+ private:
+  // sensing.py
+  void sensing_tick(uint64_t now);
+  void send_servo(int deg, uint64_t now);
+  void consume_lines();
+  // controller.py
+  void sm_tick(uint64_t now);
+  void decide_action(double dl, double dc, double dr, uint64_t now, std::string* cmd, std::string* decision);
+  void send_once(const std::string& cmd);
+  void enter_backoff(uint64_t now);
+
+  ControllerParams p_;
+  Send send_;
+  std::deque<std::string> lines_;
+  uint64_t last_hb_ms_ = 0;
+
+  std::vector<int> angles_;
+  size_t cycle_index_ = 0;
+  int center_deg_ = 90;
+  uint64_t last_scan_ms_ = 0, last_ping_ms_ = 0, servo_move_ms_ = 0;
+  std::vector<double> samples_;
+  bool awaiting_ping_ = false;
+  int current_servo_deg_ = 90;
+  int attempts_ = 0, max_attempts_ = 6;
+  double dist_left_, dist_center_, dist_right_;
+  uint64_t last_valid_center_ms_ = 0;
+
+  std::string speed_ = "FAST";
+  std::string state_ = "CRUISE";
+  std::string last_cmd_;
+  uint64_t commit_until_ms_ = 0, backoff_until_ms_ = 0, stall_start_ms_ = 0;
+  uint32_t backoffs_ = 0;
+};
+
+}  // namespace tune
+}  // namespace buggy
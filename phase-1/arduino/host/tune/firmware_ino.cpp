@@ -0,0 +1,6 @@
+// The sketch's .ino as a host translation unit (the Arduino builder would
+// otherwise do this step)
+#include <Arduino.h>
+#include "BuggyPhase1.ino"
+
+FirmwareTune g_fw_tune;
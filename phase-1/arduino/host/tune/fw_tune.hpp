@@ -0,0 +1,22 @@
+#pragma once
+// Firmware knobs the host tools vary per trial. Firmware translation units get
+// this header force-included with BUGGY_FW_TUNE defined, so the config.h
+// constants below become reads of g_fw_tune and one binary serves every trial.
+
+struct FirmwareTune {
+  unsigned long slow_pulse_on_ms = 40;
+  unsigned long slow_pulse_off_ms = 15;
+  unsigned long servo_settle_ms = 40;
+  unsigned int safety_default_cm = 0;
+  unsigned long hb_timeout_ms = 600;  // runtime-mode value; buggy_linkem sweeps it
+};
+
+extern FirmwareTune g_fw_tune;
+
+#if defined(BUGGY_FW_TUNE)
+#define SLOW_PULSE_ON_MS (g_fw_tune.slow_pulse_on_ms)
+#define SLOW_PULSE_OFF_MS (g_fw_tune.slow_pulse_off_ms)
+#define SERVO_SETTLE_MS (g_fw_tune.servo_settle_ms)
+#define SAFETY_DEFAULT_CM (g_fw_tune.safety_default_cm)
+#define HB_TIMEOUT_MS (g_fw_tune.hb_timeout_ms)
+#endif
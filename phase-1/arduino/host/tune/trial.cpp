@@ -0,0 +1,158 @@
+#include "trial.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+#include "../hal/hal.hpp"
+#include "../sim/rig.hpp"
+
+void setup();
+void loop();
+
+namespace buggy {
+namespace tune {
+namespace {
+
+// The Jetson stamps with wall-clock ms; keep its "0 = never" checks meaningful
+constexpr uint64_t kEpochMs = 1700000000000ULL;
+
+// measure_turn_rate.py against the rig: the pose is known exactly, so no
+// scan matching; HB keeps the watchdog fed as the script's pump() does
+TrialResult run_burst(const TrialSpec& spec) {
+  TrialResult res;
+  sim::Map open;
+  open.name = "open";
+  hal::reset();
+  g_fw_tune = spec.fw;
+  sim::Rig rig(open, spec.rig, spec.seed);
+  rig.attach();
+  setup();
+  auto run_for = [](int ms) {
+    uint64_t end = hal::now_ns() + (uint64_t)ms * 1000000ULL;
+    uint64_t next_hb = hal::now_ns();
+    while (hal::now_ns() < end) {
+      if (hal::now_ns() >= next_hb) {
+        hal::serial_send("HB\n");
+        next_hb += 200000000ULL;
+      }
+      loop();
+      hal::spend_us(hal::costs().loop_pass_us);
+    }
+  };
+  run_for(500);
+  const sim::Pose before = rig.pose();
+  hal::serial_send(spec.burst + "\n");
+  run_for(spec.burst_ms);
+  hal::serial_send("S\n");
+  run_for(spec.settle_ms);
+  const sim::Pose& after = rig.pose();
+  res.ok = 1;
+  res.seconds = (spec.burst_ms + spec.settle_ms) * 1e-3;
+  res.turn_deg = std::remainder(after.th - before.th, 2.0 * M_PI) * 180.0 / M_PI;
+  res.travel_cm = std::hypot(after.x - before.x, after.y - before.y);
+  return res;
+}
+
+}  // namespace
+
+TrialResult run_trial(const TrialSpec& spec) {
+  if (!spec.burst.empty()) return run_burst(spec);
+  TrialResult res;
+  sim::Map map;
+  if (!sim::make_map(spec.map, spec.seed, &map)) return res;
+
+  hal::reset();
+  g_fw_tune = spec.fw;
+  sim::Rig rig(map, spec.rig, spec.seed);
+  rig.attach();
+
+  const bool trace = spec.trace;
+  auto stamp = [] { return hal::now_ns() * 1e-9; };
+  ControllerModel ctl(spec.ctl, [&](const std::string& cmd) {
+    if (trace) std::printf("%9.3f > %s\n", stamp(), cmd.c_str());
+    hal::serial_send(cmd + "\n");
+  });
+  hal::on_serial_line([&](const std::string& line) {
+    if (trace) std::printf("%9.3f < %s\n", stamp(), line.c_str());
+    if (line == "EVT stop=safety") res.safety_stops++;
+    ctl.on_line(line);
+  });
+
+  setup();
+  const uint64_t start = hal::now_ns();
+  const uint64_t end = start + (uint64_t)(spec.seconds * 1e9);
+  const uint64_t ctl_period = (uint64_t)spec.ctl.loop_sleep_ms * 1000000ULL;
+  uint64_t next_ctl = start;
+  uint32_t last_collisions = 0;
+  while (hal::now_ns() < end) {
+    if (hal::now_ns() >= next_ctl) {
+      if (trace && rig.stats().collisions != last_collisions) {
+        last_collisions = rig.stats().collisions;
+        std::printf("%9.3f ! collision %u state=%s\n", stamp(), last_collisions, ctl.state().c_str());
+      }
+      if (trace && (hal::now_ns() / ctl_period) % 25 == 0)
+        std::printf("%9.3f @ x=%.0f y=%.0f th=%.0f servo=%.0f state=%s\n", stamp(), rig.pose().x, rig.pose().y,
+                    rig.pose().th * 180.0 / M_PI, rig.servo_deg(), ctl.state().c_str());
+      ctl.tick(kEpochMs + hal::now_ns() / 1000000ULL);
+      next_ctl += ctl_period;
+    }
+    loop();
+    hal::spend_us(hal::costs().loop_pass_us);
+  }
+
+  const sim::RigStats& st = rig.stats();
+  res.ok = 1;
+  res.seconds = (hal::now_ns() - start) * 1e-9;
+  res.forward_cm = st.forward_cm;
+  res.reverse_cm = st.reverse_cm;
+  res.collisions = st.collisions;
+  res.backoffs = ctl.backoffs();
+  res.pings = st.pings;
+  return res;
+}
+
+std::vector<TrialResult> run_parallel(const std::vector<TrialSpec>& specs, int jobs) {
+  std::vector<TrialResult> out(specs.size());
+  std::map<pid_t, std::pair<size_t, int>> running;  // pid -> (spec index, read fd)
+  size_t next = 0;
+  if (jobs < 1) jobs = 1;
+  fflush(stdout);
+  fflush(stderr);
+
+  while (next < specs.size() || !running.empty()) {
+    while (next < specs.size() && (int)running.size() < jobs) {
+      int fds[2];
+      if (pipe(fds) != 0) { perror("pipe"); break; }
+      pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        TrialResult r = run_trial(specs[next]);
+        fflush(stdout);
+        ssize_t n = write(fds[1], &r, sizeof(r));
+        _exit(n == (ssize_t)sizeof(r) ? 0 : 1);
+      }
+      close(fds[1]);
+      if (pid < 0) { perror("fork"); close(fds[0]); break; }
+      running[pid] = { next++, fds[0] };
+    }
+    if (running.empty()) break;
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    auto it = running.find(pid);
+    if (it == running.end()) continue;
+    TrialResult r;
+    // The child wrote before exiting and the result fits in one pipe buffer
+    if (read(it->second.second, &r, sizeof(r)) == (ssize_t)sizeof(r)) out[it->second.first] = r;
+    close(it->second.second);
+    running.erase(it);
+  }
+  return out;
+}
+
+}  // namespace tune
+}  // namespace buggy
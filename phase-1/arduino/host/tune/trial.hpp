@@ -0,0 +1,55 @@
+#pragma once
+// One simulated run: real firmware (host build) + controller model + rig on
+// a map. Firmware state lives in globals, so every trial runs in its own
+// forked child of a parent that has never called setup().
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../sim/rig.hpp"
+#include "controller_model.hpp"
+#include "fw_tune.hpp"
+
+namespace buggy {
+namespace tune {
+
+struct TrialSpec {
+  ControllerParams ctl;
+  FirmwareTune fw;
+  std::string map;
+  uint32_t seed = 1;
+  double seconds = 60.0;
+  bool trace = false;  // print the link traffic and pose to stdout
+  sim::RigParams rig;
+  // Set for a turn-rate trial: measure_turn_rate.py's protocol on an open
+  // floor (this command for burst_ms, then S and settle_ms) instead of the
+  // controller
+  std::string burst;
+  int burst_ms = 200;
+  int settle_ms = 300;
+};
+
+struct TrialResult {
+  uint32_t ok = 0;           // 0 = the child crashed or never reported
+  double seconds = 0.0;
+  double forward_cm = 0.0;
+  double reverse_cm = 0.0;
+  uint32_t collisions = 0;
+  uint32_t safety_stops = 0;  // EVT stop=safety from the firmware
+  uint32_t backoffs = 0;     // controller BACKOFF entries
+  uint32_t pings = 0;
+  double turn_deg = 0.0;     // turn-rate trial: heading change (+ = CCW/left)
+  double travel_cm = 0.0;    // turn-rate trial: displacement of the centre
+
+  double mean_speed_cms() const { return seconds > 0 ? (forward_cm - reverse_cm) / seconds : 0.0; }
+  double stops_per_min() const { return seconds > 0 ? (safety_stops + backoffs) * 60.0 / seconds : 0.0; }
+};
+
+// Runs in the calling process; only valid once per process
+TrialResult run_trial(const TrialSpec& spec);
+
+// Fork one child per spec, at most jobs at a time; results in spec order
+std::vector<TrialResult> run_parallel(const std::vector<TrialSpec>& specs, int jobs);
+
+}  // namespace tune
+}  // namespace buggy
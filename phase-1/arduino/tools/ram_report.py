@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+ram_report.py — static RAM budget per firmware module (+ optional live stack high-water)
+
+Reads the object files arduino-cli leaves in --build-path, sums .data/.bss per
+sketch module, and lists the largest core/library contributors. With --port it
+also asks the running firmware for `MEM?` (stack painting high-water mark).
+
+Usage examples:
+  python3 ram_report.py --compile --build-path /tmp/buggy_build
+  python3 ram_report.py --build-path /tmp/buggy_build --port /dev/ttyACM0
+"""
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+import time
+from collections import defaultdict
+from shutil import which
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "BuggyPhase1")
+RAM_TYPES = {"b", "B", "d", "D"}  # nm: .bss / .data (local + global)
+
+
+def tool(name):
+    exe = which(f"arm-none-eabi-{name}")
+    if exe:
+        return exe
+    # arduino-cli ships its own toolchain under ~/.arduino15
+    found = sorted(glob.glob(os.path.expanduser(f"~/.arduino15/packages/*/tools/arm-none-eabi-gcc/*/bin/arm-none-eabi-{name}")))
+    if found:
+        return found[-1]
+    sys.exit(f"[error] arm-none-eabi-{name} not found")
+
+
+def compile_sketch(fqbn, build_path):
+    cmd = ["arduino-cli", "compile", "--fqbn", fqbn, "--build-path", build_path, SKETCH_DIR]
+    print(f"[step] {' '.join(cmd)}")
+    subprocess.run(cmd, check=True)
+
+
+def ram_by_object(nm, obj):
+    out = subprocess.run([nm, "-S", "--size-sort", "--defined-only", obj],
+                         check=True, stdout=subprocess.PIPE, text=True).stdout
+    total = 0
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 4 or parts[2] not in RAM_TYPES:
+            continue
+        size = int(parts[1], 16)
+        total += size
+        symbols.append((size, parts[3]))
+    symbols.sort(reverse=True)
+    return total, symbols
+
+
+def elf_ram(size_tool, elf):
+    out = subprocess.run([size_tool, "-A", elf], check=True, stdout=subprocess.PIPE, text=True).stdout
+    sections = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 3 and parts[0].startswith("."):
+            sections[parts[0]] = int(parts[1])
+    return sections
+
+
+def query_mem(port, baud):
+    import serial
+    ser = serial.Serial(port, baud, timeout=0.3)
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+    ser.write(b"MEM?\n")
+    deadline = time.time() + 2.0
+    while time.time() < deadline:
+        line = ser.readline().decode("utf-8", errors="ignore").strip()
+        if line.startswith("MEM "):
+            ser.close()
+            return line
+    ser.close()
+    return None
+
+
+def main():
+    p = argparse.ArgumentParser()
+    p.add_argument("--build-path", required=True)
+    p.add_argument("--compile", action="store_true", help="run arduino-cli compile first")
+    p.add_argument("--fqbn", default="arduino:renesas_uno:unor4wifi")
+    p.add_argument("--port", default=None, help="query MEM? from a running board")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--top", type=int, default=3, help="largest symbols listed per module")
+    args = p.parse_args()
+
+    if args.compile:
+        compile_sketch(args.fqbn, args.build_path)
+
+    nm = tool("nm")
+    sketch_objs = sorted(glob.glob(os.path.join(args.build_path, "sketch", "*.o")))
+    if not sketch_objs:
+        sys.exit(f"[error] no sketch objects under {args.build_path}/sketch")
+
+    print("== Sketch modules (.data + .bss) ==")
+    sketch_total = 0
+    for obj in sketch_objs:
+        total, symbols = ram_by_object(nm, obj)
+        sketch_total += total
+        name = os.path.basename(obj).split(".")[0]
+        top = ", ".join(f"{sym}={size}" for size, sym in symbols[:args.top])
+        print(f"{name:<16} {total:>6} B  {top}")
+    print(f"{'sketch total':<16} {sketch_total:>6} B")
+
+    other = defaultdict(int)
+    for obj in glob.glob(os.path.join(args.build_path, "**", "*.o"), recursive=True):
+        if os.path.dirname(obj).endswith("sketch"):
+            continue
+        total, _ = ram_by_object(nm, obj)
+        if total:
+            rel = os.path.relpath(obj, args.build_path).split(os.sep)
+            other[rel[0] if len(rel) > 1 else "core"] += total
+    if other:
+        print("\n== Core / libraries ==")
+        for group, total in sorted(other.items(), key=lambda kv: -kv[1]):
+            print(f"{group:<16} {total:>6} B")
+
+    elfs = glob.glob(os.path.join(args.build_path, "*.elf"))
+    if elfs:
+        sections = elf_ram(tool("size"), elfs[0])
+        print("\n== Image ==")
+        for sec in (".data", ".bss", ".noinit", ".heap", ".stack_dummy"):
+            if sec in sections:
+                print(f"{sec:<16} {sections[sec]:>6} B")
+
+    if args.port:
+        line = query_mem(args.port, args.baud)
+        print("\n== Live ==")
+        print(line or "[warn] no MEM reply (is the firmware running?)")
+
+
+if __name__ == "__main__":
+    main()
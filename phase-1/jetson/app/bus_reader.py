@@ -0,0 +1,91 @@
+"""Read-only view of the buggy_busd shared-memory bus (native/include/buggy_bus.hpp).
+
+Lets Python consumers (controller, Bluetooth bridge, ...) see the latest
+firmware state without owning the serial port. Commands go to the daemon's
+FIFO via send_command().
+"""
+import math
+import mmap
+import os
+import struct
+import time
+from typing import Iterator, Optional
+
+BUS_PATH = "/dev/shm/buggy_bus"
+CMD_FIFO = "/tmp/buggy_bus.cmd"
+_MAGIC = 0xB0661EB5
+_VERSION = 1
+_STATE_TRIES = 10000  # kStateTries: state() attempts before giving up
+
+# Offsets mirror BusRegion / BuggyState / EventSlot in buggy_bus.hpp
+_HDR = struct.Struct("<IIQQ")           # magic, version, writer_ns, state_seq
+_STATE = struct.Struct("<QQ16siiffIIIIQII")
+_STATE_OFF = _HDR.size
+_EV_HEAD_OFF = _STATE_OFF + _STATE.size
+_EV_OFF = _EV_HEAD_OFF + 8
+_EV_SLOTS = 256
+_EV_TEXT = 112
+_EV = struct.Struct(f"<QQQ{_EV_TEXT}s")  # seq, index, host_ns, text
+_STATE_FIELDS = ("host_ns", "lines", "mode", "pwm_l", "pwm_r", "range_cm", "servo_deg",
+                 "bat_mv", "sag_mv", "safety_cm", "boots", "events", "link_up", "_reserved")
+
+
+class BusReader:
+    def __init__(self, path: str = BUS_PATH):
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._m = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        magic, version, _, _ = _HDR.unpack_from(self._m, 0)
+        if magic != _MAGIC or version != _VERSION:
+            raise RuntimeError("buggy bus not initialised or version mismatch")
+        self._cursor = self._u64(_EV_HEAD_OFF)
+
+    def _u64(self, off: int) -> int:
+        return struct.unpack_from("<Q", self._m, off)[0]
+
+    def state(self) -> Optional[dict]:
+        """Latest state, or None if no consistent copy was read in _STATE_TRIES
+        attempts (a writer died mid-update and no daemon has taken over)."""
+        # Seqlock read: retry while a write is in progress or raced us
+        for _ in range(_STATE_TRIES):
+            a = self._u64(16)
+            if a & 1:
+                continue
+            raw = self._m[_STATE_OFF:_STATE_OFF + _STATE.size]
+            if self._u64(16) == a:
+                break
+        else:
+            return None
+        s = dict(zip(_STATE_FIELDS, _STATE.unpack(raw)))
+        s["mode"] = s["mode"].split(b"\0", 1)[0].decode("ascii", "replace")
+        for k in ("range_cm", "servo_deg"):
+            if math.isnan(s[k]):
+                s[k] = None
+        del s["_reserved"]
+        return s
+
+    def events(self) -> Iterator[str]:
+        """New event lines since the last call (or since open)."""
+        head = self._u64(_EV_HEAD_OFF)
+        if head - self._cursor > _EV_SLOTS:
+            self._cursor = head - _EV_SLOTS
+        while self._cursor < head:
+            off = _EV_OFF + (self._cursor % _EV_SLOTS) * _EV.size
+            want = 2 * self._cursor + 2
+            seq, _, _, text = _EV.unpack_from(self._m, off)
+            if seq == want and self._u64(off) == want:
+                yield text.split(b"\0", 1)[0].decode("ascii", "replace")
+            self._cursor += 1
+
+    def writer_alive(self, max_age_s: float = 0.5) -> bool:
+        return (time.monotonic_ns() - self._u64(8)) < max_age_s * 1e9
+
+
+def send_command(line: str, fifo: str = CMD_FIFO) -> None:
+    fd = os.open(fifo, os.O_WRONLY | os.O_NONBLOCK)
+    try:
+        os.write(fd, (line.strip() + "\n").encode("ascii"))
+    finally:
+        os.close(fd)
@@ -14,7 +14,7 @@ def _deep_update(base: dict, override: dict) -> dict:
 
 def load_config() -> dict:
     parser = argparse.ArgumentParser(add_help=False)
-    parser.add_argument("--profile", choices=["tile", "carpet", "outdoors"], default=None)
+    parser.add_argument("--profile", choices=["tile", "carpet", "outdoors", "tuned"], default=None)
     parser.add_argument("--config", default=None)
     args, _ = parser.parse_known_args()
 
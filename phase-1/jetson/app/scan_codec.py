@@ -0,0 +1,107 @@
+import base64
+import struct
+from dataclasses import dataclass, field
+from typing import List, Optional
+
+# Mirrors arduino/BuggyPhase1/scan_codec.h
+SCB_VERSION = 1
+FLAG_FIXED_ANGLE = 0x01
+FLAG_FIXED_TIME = 0x02
+FLAG_DIR_LEFT = 0x04
+_HEADER = struct.Struct("<BBHIhhHHB")
+
+
+@dataclass
+class ScanFrame:
+    seq: int
+    direction: int              # +1 = sweeping toward the left limit
+    unc_max_deg: float          # worst per-sample angle uncertainty in the frame
+    angles_deg: List[float] = field(default_factory=list)
+    ranges_cm: List[float] = field(default_factory=list)   # NaN = no/invalid echo
+    t_ms: List[int] = field(default_factory=list)
+
+
+def _crc16_ccitt(data: bytes) -> int:
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+class _Reader:
+    def __init__(self, data: bytes, pos: int):
+        self._data = data
+        self.pos = pos
+
+    def varint(self) -> int:
+        shift = 0
+        value = 0
+        while True:
+            b = self._data[self.pos]
+            self.pos += 1
+            value |= (b & 0x7F) << shift
+            if b < 0x80:
+                return value
+            shift += 7
+
+    def zigzag(self) -> int:
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+
+def decode_frame(data: bytes) -> ScanFrame:
+    if len(data) < _HEADER.size + 2:
+        raise ValueError("SCB frame too short")
+    body, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+    if _crc16_ccitt(body) != crc:
+        raise ValueError("SCB checksum mismatch")
+    version, flags, seq, t0, a0, a_step, t_step, unc_max, n = _HEADER.unpack_from(body, 0)
+    if version != SCB_VERSION:
+        raise ValueError(f"SCB version {version} unsupported")
+
+    pos = _HEADER.size
+    nbitmap = (n + 7) // 8
+    bitmap = body[pos:pos + nbitmap]
+    valid = [bool(bitmap[i // 8] & (1 << (i % 8))) for i in range(n)]
+    rd = _Reader(body, pos + nbitmap)
+
+    angles = [a0]
+    if flags & FLAG_FIXED_ANGLE:
+        angles = [a0 + a_step * i for i in range(n)]
+    else:
+        for _ in range(n - 1):
+            angles.append(angles[-1] + rd.zigzag())
+    times = [t0]
+    if flags & FLAG_FIXED_TIME:
+        times = [t0 + t_step * i for i in range(n)]
+    else:
+        for _ in range(n - 1):
+            times.append(times[-1] + rd.varint())
+    ranges = []
+    prev = 0
+    for ok in valid:
+        if ok:
+            prev += rd.zigzag()
+            ranges.append(prev / 10.0)
+        else:
+            ranges.append(float("nan"))
+    if rd.pos != len(body):
+        raise ValueError("SCB trailing bytes")
+
+    return ScanFrame(
+        seq=seq,
+        direction=+1 if flags & FLAG_DIR_LEFT else -1,
+        unc_max_deg=unc_max / 100.0,
+        angles_deg=[a / 100.0 for a in angles],
+        ranges_cm=ranges,
+        t_ms=times,
+    )
+
+
+def decode_line(line: str) -> Optional[ScanFrame]:
+    """Decode an `SCB <base64>` line; returns None for any other line."""
+    if not line.startswith("SCB "):
+        return None
+    return decode_frame(base64.b64decode(line[4:].strip()))
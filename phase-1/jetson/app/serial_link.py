@@ -1,7 +1,11 @@
 import serial
 import time
+from collections import deque
 from typing import Optional
 
+_U32 = 0xFFFFFFFF
+_URGENT = ("S", "STOP")
+
 
 class SerialLink:
     def __init__(self, cfg):
@@ -10,6 +14,20 @@ class SerialLink:
         self._timeout = float(cfg["serial"]["timeout_ms"]) / 1000.0
         self._ser: Optional[serial.Serial] = None
         self._last_send = 0.0
+        # Credit-based flow control against the firmware RX ring (CR lines).
+        # _sent and _acked are cumulative byte counters modulo 2^32; _acked is
+        # None until a CR reply has synced them.
+        self._flow = bool(cfg["serial"].get("flow_control", True))
+        self._credit_wait = float(cfg["serial"].get("credit_wait_ms", 250)) / 1000.0
+        self._sent = 0
+        self._acked: Optional[int] = None
+        # Set when a CRD? sync goes unanswered (firmware without credits):
+        # sends go out unpaced until a CR line shows up again
+        self._no_credits = False
+        self._window = 255
+        self._ovf = 0
+        self._trunc = 0
+        self._pending = deque()  # lines read while waiting for credit
         self._connect()
 
     def _connect(self):
@@ -23,9 +41,80 @@ class SerialLink:
             time.sleep(0.2)
             self._ser.reset_input_buffer()
             self._ser.reset_output_buffer()
+            self._acked = None
         except Exception:
             self._ser = None
 
+    def _note_line(self, line: str):
+        # Track credits and firmware resets from any line we read
+        if line.startswith("CR "):
+            fields = dict(kv.split("=", 1) for kv in line[3:].split() if "=" in kv)
+            try:
+                b = int(fields["b"])
+                self._window = int(fields.get("win", self._window))
+                ovf = int(fields.get("ovf", 0))
+                trunc = int(fields.get("trunc", 0))
+            except (KeyError, ValueError):
+                return
+            if self._acked is None:
+                self._sent = b  # nothing of ours is in flight when we sync
+            self._acked = b
+            self._no_credits = False
+            if ovf != self._ovf or trunc != self._trunc:
+                print(f"[SERIAL] RX loss on board: ovf={ovf} trunc={trunc}")
+                self._ovf, self._trunc = ovf, trunc
+        elif line.startswith("BOOT"):
+            self._acked = None  # counters restarted with the firmware
+
+    def _read_raw(self) -> Optional[str]:
+        raw = self._ser.readline() if self._ser else b""
+        if not raw:
+            return None
+        decoded = raw.decode("utf-8", errors="ignore").strip()
+        # Debug: show all raw bytes received
+        if decoded:
+            print(f"[SERIAL] RX raw: {repr(raw)} → {repr(decoded)}")
+            self._note_line(decoded)
+        return decoded
+
+    def _sync_credits(self):
+        try:
+            self._ser.write(b"CRD?\n")
+            deadline = time.time() + self._credit_wait
+            while self._acked is None and time.time() < deadline:
+                line = self._read_raw()
+                if line and not line.startswith("CR "):
+                    self._pending.append(line)
+        except Exception:
+            pass
+
+    def _wait_credit(self, n: int):
+        if not self._flow or not self._ser or self._no_credits:
+            return
+        if self._acked is None:
+            self._sync_credits()
+            if self._acked is None:
+                # Firmware without credits: send unpaced, and don't pay
+                # credit_wait again on every send
+                print("[SERIAL] No CR reply to CRD?, sending unpaced")
+                self._no_credits = True
+                return
+        deadline = time.time() + self._credit_wait
+        while ((self._sent - self._acked) & _U32) + n > self._window:
+            if time.time() >= deadline:
+                print("[SERIAL] Credit wait timed out, resyncing")
+                self._acked = None
+                return
+            line = self._read_raw()
+            if line and not line.startswith("CR "):
+                self._pending.append(line)
+
+    def _write(self, payload: bytes):
+        self._ser.write(payload)
+        self._ser.flush()
+        self._sent = (self._sent + len(payload)) & _U32
+        self._last_send = time.time()
+
     def send_command(self, line: str):
         payload = (line.strip() + "\n").encode("utf-8")
         print(f"[SERIAL] TX: {line.strip()}")
@@ -36,9 +125,10 @@ class SerialLink:
             self._connect()
         try:
             if self._ser:
-                self._ser.write(payload)
-                self._ser.flush()
-                self._last_send = time.time()
+                # Stops go out at once; the board acts on them from its RX ISR
+                if line.strip() not in _URGENT:
+                    self._wait_credit(len(payload))
+                self._write(payload)
         except Exception as e:
             print(f"[SERIAL] Send exception: {e}")
             # attempt reconnect once
@@ -52,9 +142,7 @@ class SerialLink:
             self._connect()
             try:
                 if self._ser:
-                    self._ser.write(payload)
-                    self._ser.flush()
-                    self._last_send = time.time()
+                    self._write(payload)
             except Exception:
                 pass
 
@@ -63,15 +151,10 @@ class SerialLink:
             print("[SERIAL] Not connected, attempting reconnect...")
             time.sleep(0.5)
             self._connect()
+        if self._pending:
+            return self._pending.popleft()
         try:
-            raw = self._ser.readline() if self._ser else b""
-            if not raw:
-                return None
-            decoded = raw.decode("utf-8", errors="ignore").strip()
-            # Debug: show all raw bytes received
-            if decoded:
-                print(f"[SERIAL] RX raw: {repr(raw)} → {repr(decoded)}")
-            return decoded
+            return self._read_raw()
         except Exception as e:
             print(f"[SERIAL] Read exception: {e}")
             # reconnect and give up this cycle
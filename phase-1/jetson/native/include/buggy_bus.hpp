@@ -0,0 +1,252 @@
+// Shared-memory telemetry bus: one writer (buggy_busd, which owns the serial
+// port) publishes the latest decoded firmware state and an event stream into
+// a POSIX shm region; any number of local readers map it read-only.
+//
+// - State: a seqlock. The writer bumps the sequence to odd, stores the
+//   payload as relaxed atomic words, then bumps it to even. Readers copy and
+//   retry (a bounded number of times) if the sequence moved or was odd. No
+//   syscalls and no reader writes.
+// - Events: a ring of fixed slots, each with its own sequence stamp
+//   (2*index+2 once complete). A reader keeps its own cursor and detects
+//   when the writer has lapped it.
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace buggy {
+
+constexpr const char* kBusName = "/buggy_bus";
+constexpr const char* kCmdFifo = "/tmp/buggy_bus.cmd";
+constexpr uint32_t kBusMagic = 0xB0661EB5u;
+constexpr uint32_t kBusVersion = 1;
+constexpr uint32_t kEventSlots = 256;  // power of two
+constexpr size_t kEventText = 112;
+constexpr int kStateTries = 10000;  // read_state() attempts before giving up
+
+// Latest firmware state as decoded from STAT/ULS/SRV/BAT/DIST lines
+struct BuggyState {
+  uint64_t host_ns;        // CLOCK_MONOTONIC of the last update
+  uint64_t lines;          // firmware lines parsed
+  char mode[16];           // STAT mode name (F_FAST, SPIN_L, FOLLOW, ...)
+  int32_t pwm_l;
+  int32_t pwm_r;
+  float range_cm;          // NaN = no echo
+  float servo_deg;         // NaN until reported
+  uint32_t bat_mv;
+  uint32_t sag_mv;
+  uint32_t safety_cm;      // 0 = off
+  uint32_t boots;          // BOOT banners seen (reboots and reconnects)
+  uint64_t events;         // events published so far
+  uint32_t link_up;        // serial port open
+  uint32_t reserved;
+};
+static_assert(sizeof(BuggyState) % 8 == 0, "state is copied in 64-bit words");
+
+struct BusEvent {
+  uint64_t index;          // 0-based position in the stream
+  uint64_t host_ns;
+  char text[kEventText];   // raw firmware line, NUL-terminated
+};
+static_assert(sizeof(BusEvent) % 8 == 0, "event is copied in 64-bit words");
+
+template <typename T>
+struct SeqWords {
+  static constexpr size_t kWords = sizeof(T) / 8;
+  std::atomic<uint64_t> w[kWords];
+
+  void store(const T& v) {
+    uint64_t tmp[kWords];
+    std::memcpy(tmp, &v, sizeof(T));
+    for (size_t i = 0; i < kWords; ++i) w[i].store(tmp[i], std::memory_order_relaxed);
+  }
+  void load(T* v) const {
+    uint64_t tmp[kWords];
+    for (size_t i = 0; i < kWords; ++i) tmp[i] = w[i].load(std::memory_order_relaxed);
+    std::memcpy(v, tmp, sizeof(T));
+  }
+};
+
+struct EventSlot {
+  std::atomic<uint64_t> seq;  // 2*index+1 while writing, 2*index+2 when done
+  SeqWords<BusEvent> ev;
+};
+
+struct BusRegion {
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint64_t> writer_ns;  // writer liveness (CLOCK_MONOTONIC)
+  std::atomic<uint64_t> state_seq;
+  SeqWords<BuggyState> state;
+  std::atomic<uint64_t> ev_head;    // events published
+  EventSlot ev[kEventSlots];
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shm atomics must be lock-free");
+
+inline uint64_t monotonic_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+// Single writer. Creates (or takes over) the region.
+class BusWriter {
+ public:
+  bool open(const char* name = kBusName) {
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    bool ok = ftruncate(fd, sizeof(BusRegion)) == 0;
+    void* p = ok ? mmap(nullptr, sizeof(BusRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                 : MAP_FAILED;
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    r_ = static_cast<BusRegion*>(p);
+    // A restarted writer continues the existing stream so reader cursors stay valid
+    if (r_->magic == kBusMagic && r_->version == kBusVersion) {
+      take_over();
+      return true;
+    }
+    // Invalidate first so readers never trust a half-initialised region
+    r_->magic = 0;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    r_->version = kBusVersion;
+    r_->state_seq.store(0, std::memory_order_relaxed);
+    r_->ev_head.store(0, std::memory_order_relaxed);
+    for (auto& s : r_->ev) s.seq.store(0, std::memory_order_relaxed);
+    BuggyState init{};
+    init.range_cm = NAN;
+    init.servo_deg = NAN;
+    std::strcpy(init.mode, "UNKNOWN");
+    publish(init);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    r_->magic = kBusMagic;
+    return true;
+  }
+
+  void publish(const BuggyState& s) {
+    uint64_t q = r_->state_seq.load(std::memory_order_relaxed);
+    r_->state_seq.store(q + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r_->state.store(s);
+    r_->state_seq.store(q + 2, std::memory_order_release);
+    beat();
+  }
+
+  uint64_t push_event(const char* text) {
+    uint64_t i = r_->ev_head.load(std::memory_order_relaxed);
+    EventSlot& slot = r_->ev[i & (kEventSlots - 1)];
+    BusEvent e{};
+    e.index = i;
+    e.host_ns = monotonic_ns();
+    std::strncpy(e.text, text, kEventText - 1);
+    slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ev.store(e);
+    slot.seq.store(2 * i + 2, std::memory_order_release);
+    r_->ev_head.store(i + 1, std::memory_order_release);
+    return i + 1;
+  }
+
+  void beat() { r_->writer_ns.store(monotonic_ns(), std::memory_order_relaxed); }
+
+  // Last published state (the writer is the only one who may read it unlocked)
+  BuggyState current() const {
+    BuggyState s;
+    r_->state.load(&s);
+    return s;
+  }
+
+ private:
+  // The previous writer may have died mid-update. An odd state_seq would stall
+  // every reader and make our next publish() odd/even the wrong way round, so
+  // round it up; a half-written event slot is cleared and readers skip it.
+  void take_over() {
+    uint64_t q = r_->state_seq.load(std::memory_order_relaxed);
+    if (q & 1) r_->state_seq.store(q + 1, std::memory_order_release);
+    for (auto& s : r_->ev) {
+      if (s.seq.load(std::memory_order_relaxed) & 1) s.seq.store(0, std::memory_order_release);
+    }
+  }
+
+  BusRegion* r_ = nullptr;
+};
+
+// Any number of readers; never writes to the region.
+class BusReader {
+ public:
+  bool open(const char* name = kBusName) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+    void* p = mmap(nullptr, sizeof(BusRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    r_ = static_cast<const BusRegion*>(p);
+    if (r_->magic != kBusMagic || r_->version != kBusVersion) return false;
+    cursor_ = r_->ev_head.load(std::memory_order_acquire);  // tail new events only
+    return true;
+  }
+
+  // Consistent snapshot of the latest state. Retries while a write is in
+  // progress, but gives up after `tries` attempts so a writer that died
+  // mid-update cannot hang the reader; false leaves *out unspecified.
+  bool read_state(BuggyState* out, int tries = kStateTries) const {
+    while (tries-- > 0) {
+      uint64_t a = r_->state_seq.load(std::memory_order_acquire);
+      if (a & 1) continue;
+      r_->state.load(out);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (r_->state_seq.load(std::memory_order_relaxed) == a) return true;
+    }
+    return false;
+  }
+
+  // Next event after our cursor. Returns false when caught up. *lost counts
+  // events the writer overwrote before we got to them.
+  bool next_event(BusEvent* out, uint64_t* lost = nullptr) {
+    for (;;) {
+      uint64_t head = r_->ev_head.load(std::memory_order_acquire);
+      if (cursor_ >= head) return false;
+      if (head - cursor_ > kEventSlots) {
+        if (lost) *lost += head - kEventSlots - cursor_;
+        cursor_ = head - kEventSlots;
+      }
+      const EventSlot& slot = r_->ev[cursor_ & (kEventSlots - 1)];
+      uint64_t want = 2 * cursor_ + 2;
+      uint64_t a = slot.seq.load(std::memory_order_acquire);
+      if (a == want) {
+        slot.ev.load(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == want) {
+          ++cursor_;
+          return true;
+        }
+      }
+      // Lapped while reading, or a slot a restarted writer cleared: skip ahead
+      if (a > want || a == 0) {
+        if (lost) ++*lost;
+        ++cursor_;
+      }
+    }
+  }
+
+  // Nanoseconds since the writer last touched the region
+  uint64_t writer_age_ns() const {
+    return monotonic_ns() - r_->writer_ns.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const BusRegion* r_ = nullptr;
+  uint64_t cursor_ = 0;
+};
+
+}  // namespace buggy
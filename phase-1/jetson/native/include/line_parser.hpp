@@ -0,0 +1,19 @@
+// Decodes firmware text lines into BuggyState fields
+#pragma once
+
+#include <string>
+
+#include "buggy_bus.hpp"
+
+namespace buggy {
+
+enum class LineKind {
+  kState,   // updated the state (STAT, ULS, SRV, BAT, DIST, ...)
+  kEvent,   // belongs on the event ring (EVT, ERR, BOOT, GAPS, FAULT)
+  kOther,   // debug / replies nobody asked the bus for
+};
+
+// Updates *s from one line; returns how the line should be published.
+LineKind parse_line(const std::string& line, BuggyState* s);
+
+}  // namespace buggy
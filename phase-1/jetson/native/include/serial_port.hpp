@@ -0,0 +1,46 @@
+// Raw termios serial port with line assembly (the firmware speaks CRLF text)
+#pragma once
+
+#include <string>
+
+namespace buggy {
+
+class SerialPort {
+ public:
+  ~SerialPort() { close(); }
+  bool open(const std::string& path, int baud);
+  void close();
+  bool is_open() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+
+  // Drain readable bytes; calls on_line for each complete, trimmed line.
+  // Returns false if the port failed (cable pulled, device gone).
+  template <typename F>
+  bool read_lines(F&& on_line) {
+    char buf[256];
+    for (;;) {
+      long n = read_some(buf, sizeof buf);
+      if (n < 0) return false;
+      if (n == 0) return true;
+      for (long i = 0; i < n; ++i) {
+        char c = buf[i];
+        if (c == '\n' || c == '\r') {
+          if (!line_.empty()) on_line(line_);
+          line_.clear();
+        } else if (line_.size() < kMaxLine) {
+          line_.push_back(c);
+        }
+      }
+    }
+  }
+
+  bool write_line(const std::string& line);
+
+ private:
+  static constexpr size_t kMaxLine = 512;
+  long read_some(char* buf, unsigned long cap);
+  int fd_ = -1;
+  std::string line_;
+};
+
+}  // namespace buggy
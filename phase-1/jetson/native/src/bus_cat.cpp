@@ -0,0 +1,58 @@
+// buggy_bus_cat: inspect the shared-memory bus or send a command through it.
+//
+//   buggy_bus_cat            print the state every 200 ms and tail events
+//   buggy_bus_cat --once     print the state once
+//   buggy_bus_cat --send F160  queue a command line for the firmware
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "buggy_bus.hpp"
+
+static void print_state(const buggy::BuggyState& s, uint64_t writer_age_ns) {
+  std::printf("mode=%s pwm=%d/%d cm=", s.mode, s.pwm_l, s.pwm_r);
+  if (std::isnan(s.range_cm)) std::printf("NA"); else std::printf("%.1f", s.range_cm);
+  std::printf(" servo=");
+  if (std::isnan(s.servo_deg)) std::printf("NA"); else std::printf("%.1f", s.servo_deg);
+  std::printf(" bat_mv=%u sag_mv=%u thresh=%u link=%u lines=%llu events=%llu boots=%u age_ms=%.1f\n",
+              s.bat_mv, s.sag_mv, s.safety_cm, s.link_up, (unsigned long long)s.lines,
+              (unsigned long long)s.events, s.boots, writer_age_ns / 1e6);
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && std::strcmp(argv[1], "--send") == 0) {
+    int fd = open(buggy::kCmdFifo, O_WRONLY | O_NONBLOCK);
+    if (fd < 0) { std::perror("buggy_bus_cat: command fifo"); return 1; }
+    std::string line = std::string(argv[2]) + "\n";  // one write <= PIPE_BUF is atomic
+    bool ok = write(fd, line.data(), line.size()) == long(line.size());
+    close(fd);
+    return ok ? 0 : 1;
+  }
+
+  buggy::BusReader bus;
+  if (!bus.open()) {
+    std::fprintf(stderr, "buggy_bus_cat: bus not available (is buggy_busd running?)\n");
+    return 1;
+  }
+  buggy::BuggyState s;
+  bool once = argc >= 2 && std::strcmp(argv[1], "--once") == 0;
+  uint64_t lost = 0;
+  for (;;) {
+    if (bus.read_state(&s)) {
+      print_state(s, bus.writer_age_ns());
+    } else {
+      std::fprintf(stderr, "buggy_bus_cat: state stuck mid-update (writer died?)\n");
+      if (once) return 1;
+    }
+    if (once) return 0;
+    buggy::BusEvent e;
+    while (bus.next_event(&e, &lost)) std::printf("  #%llu %s\n", (unsigned long long)e.index, e.text);
+    if (lost) { std::printf("  (%llu events overwritten)\n", (unsigned long long)lost); lost = 0; }
+    std::fflush(stdout);
+    usleep(200000);
+  }
+}
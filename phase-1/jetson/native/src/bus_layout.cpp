@@ -0,0 +1,43 @@
+// buggy_bus_layout: print the shared-memory layout as "<name> <value>" lines,
+// so readers in other languages (app/bus_reader.py) can be checked against it.
+#include <cstddef>
+#include <cstdio>
+
+#include "buggy_bus.hpp"
+
+#define FIELD(T, f) std::printf(#T "." #f " %zu\n", offsetof(buggy::T, f))
+
+int main() {
+  std::printf("magic %u\nversion %u\n", buggy::kBusMagic, buggy::kBusVersion);
+  std::printf("event_slots %u\nevent_text %zu\nstate_tries %d\n", buggy::kEventSlots, buggy::kEventText,
+              buggy::kStateTries);
+  std::printf("BuggyState %zu\nBusEvent %zu\nEventSlot %zu\nBusRegion %zu\n", sizeof(buggy::BuggyState),
+              sizeof(buggy::BusEvent), sizeof(buggy::EventSlot), sizeof(buggy::BusRegion));
+  FIELD(BusRegion, magic);
+  FIELD(BusRegion, version);
+  FIELD(BusRegion, writer_ns);
+  FIELD(BusRegion, state_seq);
+  FIELD(BusRegion, state);
+  FIELD(BusRegion, ev_head);
+  FIELD(BusRegion, ev);
+  FIELD(EventSlot, seq);
+  FIELD(EventSlot, ev);
+  FIELD(BusEvent, index);
+  FIELD(BusEvent, host_ns);
+  FIELD(BusEvent, text);
+  FIELD(BuggyState, host_ns);
+  FIELD(BuggyState, lines);
+  FIELD(BuggyState, mode);
+  FIELD(BuggyState, pwm_l);
+  FIELD(BuggyState, pwm_r);
+  FIELD(BuggyState, range_cm);
+  FIELD(BuggyState, servo_deg);
+  FIELD(BuggyState, bat_mv);
+  FIELD(BuggyState, sag_mv);
+  FIELD(BuggyState, safety_cm);
+  FIELD(BuggyState, boots);
+  FIELD(BuggyState, events);
+  FIELD(BuggyState, link_up);
+  FIELD(BuggyState, reserved);
+  return 0;
+}
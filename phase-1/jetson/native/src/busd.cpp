@@ -0,0 +1,165 @@
+// buggy_busd: owns the serial link to the Phase 1 firmware and publishes the
+// decoded state and events on the shared-memory bus (see buggy_bus.hpp).
+// Other processes send commands by writing lines into the command FIFO.
+//
+//   buggy_busd [--port /dev/ttyACM0] [--baud 115200] [--hb-ms 0]
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "buggy_bus.hpp"
+#include "line_parser.hpp"
+#include "serial_port.hpp"
+
+namespace {
+
+volatile std::sig_atomic_t g_quit = 0;
+void on_signal(int) { g_quit = 1; }
+
+struct Options {
+  std::string port = "/dev/ttyACM0";
+  int baud = 115200;
+  std::string fifo = buggy::kCmdFifo;
+  int hb_ms = 0;  // >0: send HB ourselves when no HB (ours or a client's) went out
+};
+
+Options parse_args(int argc, char** argv) {
+  Options o;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string k = argv[i];
+    if (k == "--port") o.port = argv[i + 1];
+    else if (k == "--baud") o.baud = std::atoi(argv[i + 1]);
+    else if (k == "--fifo") o.fifo = argv[i + 1];
+    else if (k == "--hb-ms") o.hb_ms = std::atoi(argv[i + 1]);
+    else std::fprintf(stderr, "buggy_busd: ignoring %s\n", k.c_str());
+  }
+  return o;
+}
+
+// Reads whole lines out of the command FIFO
+class CommandFifo {
+ public:
+  bool open(const std::string& path) {
+    // Owner and group only: anyone who can write here can drive the motors.
+    // /tmp is shared, so refuse a symlink or a FIFO someone else planted.
+    if (mkfifo(path.c_str(), 0660) != 0 && errno != EEXIST) return false;
+    fd_ = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_NOFOLLOW);
+    if (fd_ < 0) return false;
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || !S_ISFIFO(st.st_mode) || st.st_uid != geteuid()) {
+      ::close(fd_);
+      fd_ = -1;
+      errno = EPERM;
+      return false;
+    }
+    fchmod(fd_, 0660);  // mkfifo's mode went through the umask; an older FIFO may be 0666
+    // Hold a writer end ourselves so the FIFO never reports EOF between clients
+    keep_ = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_NOFOLLOW);
+    return true;
+  }
+  int fd() const { return fd_; }
+  template <typename F>
+  void read_lines(F&& on_line) {
+    char buf[512];
+    long n;
+    while ((n = ::read(fd_, buf, sizeof buf)) > 0) {
+      for (long i = 0; i < n; ++i) {
+        if (buf[i] == '\n' || buf[i] == '\r') {
+          if (!pending_.empty()) on_line(pending_);
+          pending_.clear();
+        } else if (pending_.size() < 256) {
+          pending_.push_back(buf[i]);
+        }
+      }
+    }
+  }
+
+ private:
+  int fd_ = -1;
+  int keep_ = -1;
+  std::string pending_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt = parse_args(argc, argv);
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  buggy::BusWriter bus;
+  if (!bus.open()) {
+    std::perror("buggy_busd: shm_open");
+    return 1;
+  }
+  CommandFifo cmds;
+  if (!cmds.open(opt.fifo)) {
+    std::perror("buggy_busd: command fifo");
+    return 1;
+  }
+
+  buggy::SerialPort link;
+  buggy::BuggyState state = bus.current();
+  uint64_t last_try_ns = 0;
+  uint64_t last_hb_ns = 0;  // only HB feeds the firmware watchdog, not VT or motion
+
+  while (!g_quit) {
+    uint64_t now = buggy::monotonic_ns();
+    if (!link.is_open() && now - last_try_ns > 500000000ull) {
+      last_try_ns = now;
+      if (link.open(opt.port, opt.baud)) {
+        std::fprintf(stderr, "buggy_busd: %s open\n", opt.port.c_str());
+        state.link_up = 1;
+        bus.publish(state);
+      }
+    }
+
+    pollfd fds[2] = {{cmds.fd(), POLLIN, 0}, {link.fd(), POLLIN, 0}};
+    int nfds = link.is_open() ? 2 : 1;
+    poll(fds, nfds, 50);
+
+    if (fds[0].revents & POLLIN) {
+      cmds.read_lines([&](const std::string& line) {
+        if (link.write_line(line) && line == "HB") last_hb_ns = buggy::monotonic_ns();
+      });
+    }
+
+    if (link.is_open() && opt.hb_ms > 0 &&
+        buggy::monotonic_ns() - last_hb_ns > uint64_t(opt.hb_ms) * 1000000ull) {
+      if (link.write_line("HB")) last_hb_ns = buggy::monotonic_ns();
+    }
+
+    if (nfds == 2 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+      bool changed = false;
+      bool ok = link.read_lines([&](const std::string& line) {
+        state.lines++;
+        buggy::LineKind kind = buggy::parse_line(line, &state);
+        if (kind == buggy::LineKind::kEvent) state.events = bus.push_event(line.c_str());
+        if (kind != buggy::LineKind::kOther) changed = true;
+      });
+      if (!ok) {
+        std::fprintf(stderr, "buggy_busd: %s lost\n", opt.port.c_str());
+        link.close();
+        state.link_up = 0;
+        changed = true;
+      }
+      if (changed) {
+        state.host_ns = buggy::monotonic_ns();
+        bus.publish(state);
+      }
+    }
+    bus.beat();
+  }
+
+  // Leave the buggy stopped rather than relying on its watchdog
+  if (link.is_open()) link.write_line("S");
+  return 0;
+}
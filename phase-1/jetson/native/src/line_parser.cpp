@@ -0,0 +1,93 @@
+#include "line_parser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace buggy {
+
+static bool starts_with(const std::string& s, const char* p) {
+  return s.compare(0, std::strlen(p), p) == 0;
+}
+
+// Value of "key=" in a space/comma separated line, or nullptr
+static const char* field(const std::string& line, const char* key) {
+  size_t k = std::strlen(key);
+  size_t pos = 0;
+  while ((pos = line.find(key, pos)) != std::string::npos) {
+    bool at_token = pos == 0 || line[pos - 1] == ' ' || line[pos - 1] == ',';
+    if (at_token && pos + k < line.size() && line[pos + k] == '=') return line.c_str() + pos + k + 1;
+    pos += k;
+  }
+  return nullptr;
+}
+
+static float cm_value(const char* v) {
+  if (!v || v[0] == 'N' || v[0] == '-') return NAN;  // NA / -1 = no echo
+  return std::strtof(v, nullptr);
+}
+
+static void set_mode(BuggyState* s, const char* begin, size_t n) {
+  n = std::min(n, sizeof(s->mode) - 1);
+  std::memcpy(s->mode, begin, n);
+  s->mode[n] = '\0';
+}
+
+// STAT,<mode>,<pwmL>,<pwmR>,<cm|NA>[,BAT=<mv>,SAG=<mv>][,MODE=BENCH]
+static void parse_stat_csv(const std::string& line, BuggyState* s) {
+  const char* p = line.c_str() + 5;
+  const char* comma = std::strchr(p, ',');
+  if (!comma) return;
+  set_mode(s, p, size_t(comma - p));
+  char* end;
+  s->pwm_l = int32_t(std::strtol(comma + 1, &end, 10));
+  if (*end != ',') return;
+  s->pwm_r = int32_t(std::strtol(end + 1, &end, 10));
+  if (*end != ',') return;
+  s->range_cm = cm_value(end + 1);
+  if (const char* v = field(line, "BAT")) s->bat_mv = uint32_t(std::strtoul(v, nullptr, 10));
+  if (const char* v = field(line, "SAG")) s->sag_mv = uint32_t(std::strtoul(v, nullptr, 10));
+}
+
+LineKind parse_line(const std::string& line, BuggyState* s) {
+  if (starts_with(line, "STAT,")) {
+    parse_stat_csv(line, s);
+    return LineKind::kState;
+  }
+  if (starts_with(line, "STAT ")) {
+    // STAT mode=<c> spd=<pwm> thresh=<cm> last_cm=<cm|-1> sweep=<0|1>
+    if (const char* v = field(line, "thresh")) s->safety_cm = uint32_t(std::strtoul(v, nullptr, 10));
+    if (const char* v = field(line, "last_cm")) s->range_cm = cm_value(v);
+    return LineKind::kState;
+  }
+  if (starts_with(line, "ULS ")) {
+    if (const char* v = field(line, "cm")) s->range_cm = cm_value(v);
+    if (const char* v = field(line, "angle")) s->servo_deg = std::strtof(v, nullptr);
+    return LineKind::kState;
+  }
+  if (starts_with(line, "SRV ")) {
+    if (const char* v = field(line, "pos_cdeg")) s->servo_deg = std::strtof(v, nullptr) / 100.0f;
+    return LineKind::kState;
+  }
+  if (starts_with(line, "BAT ")) {
+    if (const char* v = field(line, "mv")) s->bat_mv = uint32_t(std::strtoul(v, nullptr, 10));
+    if (const char* v = field(line, "sag_mv")) s->sag_mv = uint32_t(std::strtoul(v, nullptr, 10));
+    return LineKind::kState;
+  }
+  if (starts_with(line, "DIST,")) {
+    s->range_cm = cm_value(line.c_str() + 5);
+    return LineKind::kState;
+  }
+  if (starts_with(line, "BOOT")) {
+    s->boots++;
+    return LineKind::kEvent;
+  }
+  if (starts_with(line, "EVT") || starts_with(line, "ERR") || starts_with(line, "GAPS") ||
+      starts_with(line, "FAULT") || line == "REASON=WDG") {
+    return LineKind::kEvent;
+  }
+  return LineKind::kOther;
+}
+
+}  // namespace buggy
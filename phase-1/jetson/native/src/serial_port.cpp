@@ -0,0 +1,66 @@
+#include "serial_port.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace buggy {
+
+static speed_t to_speed(int baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    default: return B115200;
+  }
+}
+
+bool SerialPort::open(const std::string& path, int baud) {
+  close();
+  fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd_ < 0) return false;
+  termios tio{};
+  if (tcgetattr(fd_, &tio) != 0) { close(); return false; }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, to_speed(baud));
+  cfsetospeed(&tio, to_speed(baud));
+  tio.c_cflag |= CLOCAL | CREAD;
+  // VMIN=1 with O_NONBLOCK: "no data" is EAGAIN, so a 0-byte read means hang-up
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  // Non-tty paths (ptys, test FIFOs) may refuse some attributes; keep going
+  tcsetattr(fd_, TCSANOW, &tio);
+  line_.clear();
+  return true;
+}
+
+void SerialPort::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+}
+
+long SerialPort::read_some(char* buf, unsigned long cap) {
+  long n = ::read(fd_, buf, cap);
+  if (n > 0) return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  return -1;  // EOF (O_NONBLOCK reports "no data" as EAGAIN) or I/O error
+}
+
+bool SerialPort::write_line(const std::string& line) {
+  if (fd_ < 0) return false;
+  std::string out = line + "\n";
+  size_t off = 0;
+  while (off < out.size()) {
+    long n = ::write(fd_, out.data() + off, out.size() - off);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EINTR) { usleep(200); continue; }
+      return false;
+    }
+    off += size_t(n);
+  }
+  return true;
+}
+
+}  // namespace buggy
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+measure_turn_rate.py — turn rate of each drive mode, measured with the ultrasonic sweep
+
+No IMU on Phase-1, so heading change is recovered by scan matching: take a
+sweep profile at rest, run the mode for a short burst, stop, take another
+profile, and find the angular shift that best aligns the two. Keep bursts
+short enough that the turn stays well inside the sweep span (~90°).
+
+Run in a cluttered spot (flat walls all round give no angular signal).
+
+Usage:
+  python3 scripts/measure_turn_rate.py --port /dev/ttyACM0 --burst-ms 200 --trials 3
+"""
+import argparse
+import math
+import os
+import statistics
+import sys
+import time
+
+import serial
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from app.scan_codec import decode_line  # noqa: E402
+
+MODES = ["SPINL", "SPINR", "PIVOTL", "PIVOTR", "FSPINL", "FSPINR",
+         "RSPINL", "RSPINR", "XSPINL", "XSPINR"]
+
+
+class Link:
+    def __init__(self, port, baud):
+        self._ser = serial.Serial(port, baud, timeout=0.05, write_timeout=0.2)
+        self._last_hb = 0.0
+        time.sleep(0.2)
+        self._ser.reset_input_buffer()
+
+    def send(self, line):
+        self._ser.write((line + "\n").encode("utf-8"))
+
+    def pump(self):
+        # Keep the firmware watchdog fed while we wait
+        now = time.time()
+        if now - self._last_hb >= 0.2:
+            self.send("HB")
+            self._last_hb = now
+        raw = self._ser.readline()
+        return raw.decode("utf-8", errors="ignore").strip() if raw else ""
+
+    def wait(self, seconds):
+        end = time.time() + seconds
+        while time.time() < end:
+            self.pump()
+
+    def next_frame(self, timeout=3.0):
+        end = time.time() + timeout
+        while time.time() < end:
+            line = self.pump()
+            if line.startswith("SCB "):
+                try:
+                    return decode_line(line)
+                except ValueError:
+                    continue
+        raise RuntimeError("no SCB frame (is the firmware sweeping?)")
+
+    def close(self):
+        self.send("S")
+        self.send("SWEEP,OFF")
+        self._ser.close()
+
+
+def profile(frame, lo, hi):
+    # Resample valid ranges onto a 1° grid by linear interpolation
+    pts = sorted((a, r) for a, r in zip(frame.angles_deg, frame.ranges_cm) if not math.isnan(r))
+    grid = {}
+    for (a0, r0), (a1, r1) in zip(pts, pts[1:]):
+        if a1 - a0 > 10:
+            continue  # don't bridge a long dropout
+        for deg in range(math.ceil(a0), math.floor(a1) + 1):
+            if lo <= deg <= hi and a1 > a0:
+                grid[deg] = r0 + (r1 - r0) * (deg - a0) / (a1 - a0)
+    return grid
+
+
+def best_shift(before, after, max_shift):
+    # after(a) ≈ before(a + δ) when the buggy turned left (CCW) by δ
+    best = (float("inf"), 0)
+    for d in range(-max_shift, max_shift + 1):
+        diffs = [abs(r - before[a + d]) for a, r in after.items() if (a + d) in before]
+        if len(diffs) < 15:
+            continue
+        cost = statistics.mean(diffs)
+        if cost < best[0]:
+            best = (cost, d)
+    return best[1], best[0]
+
+
+def main():
+    p = argparse.ArgumentParser()
+    p.add_argument("--port", default="/dev/ttyACM0")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--modes", default=",".join(MODES))
+    p.add_argument("--speed", type=int, default=160, help="PWM suffix sent with each mode")
+    p.add_argument("--burst-ms", type=int, default=200)
+    p.add_argument("--settle-ms", type=int, default=300)
+    p.add_argument("--trials", type=int, default=3)
+    p.add_argument("--max-shift", type=int, default=40)
+    args = p.parse_args()
+
+    link = Link(args.port, args.baud)
+    link.send("SCAN,BIN")
+    link.send("SWEEP,ON")
+    link.next_frame()  # discard the partial first pass
+
+    results = {}
+    try:
+        for mode in args.modes.split(","):
+            rates = []
+            for _ in range(args.trials):
+                before = profile(link.next_frame(), 45, 135)
+                link.send(f"{mode}{args.speed}")
+                link.wait(args.burst_ms / 1000.0)
+                link.send("S")
+                link.wait(args.settle_ms / 1000.0)
+                link.next_frame()  # pass that straddled the motion
+                after = profile(link.next_frame(), 45, 135)
+                shift, cost = best_shift(before, after, args.max_shift)
+                rate = shift / (args.burst_ms / 1000.0)
+                rates.append(rate)
+                print(f"[{mode}] shift={shift:+d}° fit={cost:.1f}cm rate={rate:+.0f}°/s")
+            results[mode] = rates
+    finally:
+        link.close()
+
+    print("\nmode     median°/s  min     max   (+ = CCW/left)")
+    for mode, rates in results.items():
+        print(f"{mode:<8} {statistics.median(rates):+8.0f} {min(rates):+6.0f} {max(rates):+6.0f}")
+
+
+if __name__ == "__main__":
+    main()
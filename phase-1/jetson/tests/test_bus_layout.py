@@ -0,0 +1,89 @@
+"""app/bus_reader.py against the C++ bus layout (native/include/buggy_bus.hpp).
+
+BUGGY_BUS_LAYOUT names the buggy_bus_layout binary; ctest in native/ sets it.
+Run from phase-1/jetson: python3 -m unittest tests.test_bus_layout
+"""
+import os
+import struct
+import subprocess
+import tempfile
+import unittest
+
+from app import bus_reader as br
+
+
+def _layout() -> dict:
+    out = subprocess.run([os.environ["BUGGY_BUS_LAYOUT"]], check=True, capture_output=True, text=True).stdout
+    return {k: int(v) for k, v in (line.split() for line in out.splitlines())}
+
+
+def _offsets(fmt: struct.Struct, names) -> dict:
+    """Field offsets of a packed little-endian struct, one name per code."""
+    codes, offs, i = fmt.format[1:], {}, 0
+    for name in names:
+        n = ""
+        while codes[i].isdigit():
+            n += codes[i]
+            i += 1
+        prefix = codes[:i + 1]
+        offs[name] = struct.calcsize("<" + prefix) - struct.calcsize("<" + (n or "1") + codes[i])
+        i += 1
+    return offs
+
+
+@unittest.skipUnless(os.environ.get("BUGGY_BUS_LAYOUT"), "BUGGY_BUS_LAYOUT not set")
+class BusLayoutTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.c = _layout()
+
+    def test_constants(self):
+        self.assertEqual(br._MAGIC, self.c["magic"])
+        self.assertEqual(br._VERSION, self.c["version"])
+        self.assertEqual(br._EV_SLOTS, self.c["event_slots"])
+        self.assertEqual(br._EV_TEXT, self.c["event_text"])
+        self.assertEqual(br._STATE_TRIES, self.c["state_tries"])
+
+    def test_region(self):
+        self.assertEqual(self.c["BusRegion.magic"], 0)
+        self.assertEqual(self.c["BusRegion.version"], 4)
+        self.assertEqual(self.c["BusRegion.writer_ns"], 8)
+        self.assertEqual(self.c["BusRegion.state_seq"], 16)
+        self.assertEqual(br._HDR.size, self.c["BusRegion.state"])
+        self.assertEqual(br._STATE_OFF, self.c["BusRegion.state"])
+        self.assertEqual(br._EV_HEAD_OFF, self.c["BusRegion.ev_head"])
+        self.assertEqual(br._EV_OFF, self.c["BusRegion.ev"])
+        self.assertEqual(br._EV_OFF + br._EV_SLOTS * br._EV.size, self.c["BusRegion"])
+
+    def test_state(self):
+        self.assertEqual(br._STATE.size, self.c["BuggyState"])
+        offs = _offsets(br._STATE, br._STATE_FIELDS)
+        for name, off in offs.items():
+            key = "BuggyState." + ("reserved" if name == "_reserved" else name)
+            self.assertEqual(off, self.c[key], key)
+
+    def test_event_slot(self):
+        self.assertEqual(br._EV.size, self.c["EventSlot"])
+        offs = _offsets(br._EV, ("seq", "index", "host_ns", "text"))
+        self.assertEqual(offs["seq"], self.c["EventSlot.seq"])
+        ev = self.c["EventSlot.ev"]
+        for name in ("index", "host_ns", "text"):
+            self.assertEqual(offs[name], ev + self.c["BusEvent." + name], name)
+
+
+class BusReaderTest(unittest.TestCase):
+    def test_state_gives_up_on_a_stuck_write(self):
+        with tempfile.NamedTemporaryFile() as f:
+            f.write(bytes(br._EV_OFF + br._EV_SLOTS * br._EV.size))
+            f.seek(0)
+            f.write(br._HDR.pack(br._MAGIC, br._VERSION, 0, 3))  # state_seq odd: writer died mid-update
+            f.flush()
+            self.assertIsNone(br.BusReader(f.name).state())
+            f.seek(0)
+            f.write(br._HDR.pack(br._MAGIC, br._VERSION, 0, 4))
+            f.flush()
+            self.assertEqual(br.BusReader(f.name).state()["lines"], 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
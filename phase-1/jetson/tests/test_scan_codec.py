@@ -0,0 +1,65 @@
+"""app/scan_codec.py against the firmware encoder (arduino/BuggyPhase1/scan_codec.cpp).
+
+BUGGY_SCB_DUMP names the scan_codec_dump binary from arduino/host; ctest there
+sets it. Run from phase-1/jetson: python3 -m unittest tests.test_scan_codec
+"""
+import base64
+import json
+import math
+import os
+import subprocess
+import unittest
+
+from app import scan_codec as sc
+
+
+def _dump():
+    out = subprocess.run([os.environ["BUGGY_SCB_DUMP"]], check=True, capture_output=True, text=True).stdout
+    lines = [json.loads(line) for line in out.splitlines()]
+    return lines[0]["fit_cdeg"], lines[1:]
+
+
+@unittest.skipUnless(os.environ.get("BUGGY_SCB_DUMP"), "BUGGY_SCB_DUMP not set")
+class ScanCodecRoundTripTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.fit_cdeg, cls.frames = _dump()
+
+    def test_frames_decode_to_what_was_encoded(self):
+        self.assertEqual(len(self.frames), 3)
+        for exp in self.frames:
+            with self.subTest(seq=exp["seq"]):
+                raw = base64.b64decode(exp["line"][4:])
+                flags = raw[1]
+                got = sc.decode_line(exp["line"])
+                samples = exp["samples"]
+                self.assertEqual(got.seq, exp["seq"])
+                self.assertEqual(got.direction, exp["dir"])
+                # Per-sample uncertainty is reduced to the frame's worst case
+                self.assertEqual(got.unc_max_deg, max(s[1] for s in samples) / 100.0)
+                self.assertEqual(len(got.angles_deg), len(samples))
+                a_tol = self.fit_cdeg if flags & sc.FLAG_FIXED_ANGLE else 0
+                t_tol = 1 if flags & sc.FLAG_FIXED_TIME else 0
+                for i, (a, _, mm, dt) in enumerate(samples):
+                    self.assertLessEqual(abs(got.angles_deg[i] * 100.0 - a), a_tol + 1e-6, f"angle {i}")
+                    self.assertLessEqual(abs(got.t_ms[i] - (exp["t0_ms"] + dt)), t_tol, f"time {i}")
+                    if mm:
+                        self.assertEqual(got.ranges_cm[i], mm / 10.0, f"range {i}")
+                    else:
+                        self.assertTrue(math.isnan(got.ranges_cm[i]), f"range {i}")
+
+    def test_both_step_encodings_covered(self):
+        flags = [base64.b64decode(f["line"][4:])[1] for f in self.frames]
+        self.assertTrue(any(f & sc.FLAG_FIXED_ANGLE for f in flags))
+        self.assertTrue(any(not f & sc.FLAG_FIXED_ANGLE for f in flags))
+        self.assertTrue(any(not f & sc.FLAG_FIXED_TIME for f in flags))
+
+    def test_corrupt_frame_rejected(self):
+        raw = bytearray(base64.b64decode(self.frames[0]["line"][4:]))
+        raw[10] ^= 0x01
+        with self.assertRaises(ValueError):
+            sc.decode_frame(bytes(raw))
+
+
+if __name__ == "__main__":
+    unittest.main()
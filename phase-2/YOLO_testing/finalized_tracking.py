@@ -7,11 +7,13 @@ Highlights:
 - Keeps Kalman as the constant motion backbone.
 - Hot-swaps identity mode between none / histogram / embeddings.
 - Supports sampled embedding refresh with SKIP_FRAMES = N.
+- Optionally streams the target bearing to the buggy's FOLLOW mode through buggy_busd (--follow).
 """
 
 from __future__ import annotations
 
 import argparse
+import sys
 import time
 from pathlib import Path
 from typing import List, Optional, Sequence, Tuple
@@ -425,6 +427,51 @@ class FinalizedTracker:
         return None, False, debug
 
 
+class FollowLink:
+    """Streams `VT,<bearing_deg>,NA,<age_ms>` to the Phase 1 firmware.
+
+    The board predicts the bearing between frames and steers at motor-loop
+    rate, so every fresh (non-ghost) fix is sent as-is with its capture age.
+    Lines go through buggy_busd's command FIFO (phase-1/jetson/native): the
+    daemon owns the serial port, so the controller and this tracker share it.
+    VT does not feed the board's watchdog, so HB keeps going while following.
+    """
+
+    HB_PERIOD_S = 0.2
+
+    def __init__(self, fifo: Optional[str], hfov_deg: float, dist_cm: int):
+        sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "phase-1" / "jetson"))
+        from app.bus_reader import CMD_FIFO, send_command
+
+        self._send_command = send_command
+        self.fifo = fifo or CMD_FIFO
+        self.hfov_deg = hfov_deg
+        self.last_hb = 0.0
+        self._send(f"FOLLOW,ON,{dist_cm}")
+
+    def _send(self, line: str) -> None:
+        try:
+            self._send_command(line, self.fifo)
+        except OSError as exc:
+            print(f"[follow] send failed (is buggy_busd running?): {exc}")
+
+    def update(self, box: Optional[np.ndarray], is_ghost: bool, frame_width: int, capture_t: float) -> None:
+        if box is not None and not is_ghost:
+            cx = 0.5 * (float(box[0]) + float(box[2]))
+            # Pinhole mapping; + = left of the optical axis
+            half = 0.5 * frame_width
+            focal = half / np.tan(np.radians(0.5 * self.hfov_deg))
+            bearing = float(np.degrees(np.arctan((half - cx) / focal)))
+            age_ms = int((time.perf_counter() - capture_t) * 1000.0)
+            self._send(f"VT,{bearing:.1f},NA,{age_ms}")
+        if time.time() - self.last_hb >= self.HB_PERIOD_S:
+            self._send("HB")
+            self.last_hb = time.time()
+
+    def close(self) -> None:
+        self._send("FOLLOW,OFF")
+
+
 def build_identity_scorer(args) -> IdentityScorer:
     if args.identity_mode == "none":
         return IdentityScorer()
@@ -509,6 +556,10 @@ def main() -> None:
     parser.add_argument("--camera-height", type=int, default=0, help="Optional camera height override")
     parser.add_argument("--headless", action="store_true", help="Disable OpenCV window rendering for true loop-FPS testing")
     parser.add_argument("--profile", action="store_true", help="Print timing breakdown every 30 frames")
+    parser.add_argument("--follow", action="store_true", help="Drive the buggy in FOLLOW mode through buggy_busd")
+    parser.add_argument("--follow-fifo", type=str, default=None, help="buggy_busd command FIFO (default /tmp/buggy_bus.cmd)")
+    parser.add_argument("--follow-hfov-deg", type=float, default=62.2, help="Camera horizontal field of view")
+    parser.add_argument("--follow-dist-cm", type=int, default=80, help="Stand-off distance kept by the buggy")
     args = parser.parse_args()
 
     weights_path = Path(args.weights)
@@ -537,6 +588,8 @@ def main() -> None:
     if args.camera_height > 0:
         cap.set(cv2.CAP_PROP_FRAME_HEIGHT, args.camera_height)
 
+    follow = FollowLink(args.follow_fifo, args.follow_hfov_deg, args.follow_dist_cm) if args.follow else None
+
     window_name = "Phase 2 - Finalized Tracking"
     if not args.headless:
         cv2.namedWindow(window_name, cv2.WINDOW_NORMAL)
@@ -585,6 +638,8 @@ def main() -> None:
 
         tracked_box, is_ghost, debug = tracker.process(frame, boxes, confs, classes)
         t_after_track = time.perf_counter()
+        if follow is not None:
+            follow.update(tracked_box, is_ghost, frame.shape[1], loop_t0)
 
         curr_time = time.time()
         instant_fps = 1.0 / max(curr_time - prev_time, 1e-6)
@@ -620,6 +675,8 @@ def main() -> None:
             render_ms = 0.0
 
     cap.release()
+    if follow is not None:
+        follow.close()
     if not args.headless:
         cv2.destroyAllWindows()
 
@@ -18,6 +18,7 @@ Protocol (Phone → Jetson):
     {"cmd": "move", "dir": "fwd", "speed": 0.7}
     {"cmd": "move", "dir": "stop"}
     {"cmd": "ping"}
+    {"cmd": "teach", "action": "rec"|"end"|"play"}   (on-board teach-and-repeat)
     {"type": "remote", "direction": "forward"}   (DPad format)
 
 Protocol (Jetson → Phone):
@@ -68,6 +69,13 @@ DIR_MAP = {
     "stop":    "S",
 }
 
+# Teach-and-repeat action → Arduino line (recorded and replayed on the board)
+TEACH_MAP = {
+    "rec":  "REC,ON",
+    "end":  "REC,OFF",
+    "play": "PLAY",
+}
+
 # ── Globals ─────────────────────────────────────────────────────────────────
 
 running = True
@@ -216,6 +224,14 @@ def handle_command(data: dict, arduino: ArduinoSerial) -> dict:
     elif cmd == "ping":
         return {"type": "ack", "cmd": "ping", "ok": True}
 
+    elif cmd == "teach":
+        action = data.get("action", "").lower()
+        line = TEACH_MAP.get(action)
+        if line is None:
+            return {"type": "error", "msg": f"Unknown teach action: {action}"}
+        arduino.send(line)
+        return {"type": "ack", "cmd": "teach", "action": action, "ok": True}
+
     elif cmd == "mode":
         mode = data.get("value", "rc")
         print(f"   📡 Mode switch requested: {mode}")